@@ -1,7 +1,10 @@
 #pragma once
 
 #include <cmath>
+#include <cstdlib>
 #include <limits>
+#include <memory>
+#include <new>
 #include "cloudkey.hpp"
 #include "detwfa.hpp"
 #include "keyswitch.hpp"
@@ -11,38 +14,144 @@
 
 namespace TFHEpp {
 
+// Modulus switches tlwe to the rotation amounts of BlindRotate<P, num_out>.
+template <class P, uint32_t num_out = 1>
+void RotationIndicesgen(RotationIndices<P> &idx,
+                        const TLWE<typename P::domainP> &tlwe)
+{
+    constexpr uint32_t bitwidth = bits_needed<num_out - 1>();
+    constexpr typename P::domainP::T roundoffset =
+        1ULL << (std::numeric_limits<typename P::domainP::T>::digits - 2 -
+                 P::targetP::nbit + bitwidth);
+    for (int i = 0; i < P::domainP::k * P::domainP::n; i++)
+        idx[i] = (tlwe[i] + roundoffset) >>
+                 (std::numeric_limits<typename P::domainP::T>::digits - 1 -
+                  P::targetP::nbit + bitwidth)
+                     << bitwidth;
+    idx[P::domainP::k * P::domainP::n] =
+        2 * P::targetP::n -
+        ((tlwe[P::domainP::k * P::domainP::n] >>
+          (std::numeric_limits<typename P::domainP::T>::digits - 1 -
+           P::targetP::nbit + bitwidth))
+         << bitwidth);
+}
+
+// Blind rotation by rotation amounts that are already modulus switched, e.g.
+// by RotationIndicesgen or IdentityKeySwitchModSwitch. num_out must match the
+// one they were computed for.
+template <class P, uint32_t num_out = 1>
+void BlindRotate(TRLWE<typename P::targetP> &res, const RotationIndices<P> &idx,
+                 const BootstrappingKeyFFT<P> &bkfft,
+                 const Polynomial<typename P::targetP> &testvector)
+{
+    const BlindRotateScope scope;
+    res = {};
+    PolynomialMulByXai<typename P::targetP>(
+        res[P::targetP::k], testvector, idx[P::domainP::k * P::domainP::n]);
+
+    if constexpr (P::Addends == 1) {
+        for (int i = 0; i < P::domainP::k * P::domainP::n; i++) {
+            const uint32_t aLong = idx[i];
+            if (aLong == 0) {
+                blindrotatestats.cmux_skipped++;
+                continue;
+            }
+            blindrotatestats.cmux_executed++;
+            // Do not use CMUXFFT to avoid unnecessary copy.
+            CMUXFFTwithPolynomialMulByXaiMinusOne<P>(res, bkfft[i], aLong);
+        }
+    }
+    else {
+        // Unrolled blind rotation: one external product per Addends
+        // coefficients.
+        for (int i = 0; i < P::domainP::k * P::domainP::n / P::Addends; i++) {
+            std::array<int, P::Addends> aLongs;
+            bool iszero = true;
+            for (int t = 0; t < P::Addends; t++) {
+                aLongs[t] = idx[i * P::Addends + t];
+                iszero &= aLongs[t] == 0;
+            }
+            if (iszero) {
+                blindrotatestats.cmux_skipped++;
+                continue;
+            }
+            blindrotatestats.cmux_executed++;
+            CMUXFFTwithPolynomialMulByXaiMinusOne<P>(res, bkfft[i], aLongs);
+        }
+    }
+}
+
 template <class P, uint32_t num_out = 1>
 void BlindRotate(TRLWE<typename P::targetP> &res,
                  const TLWE<typename P::domainP> &tlwe,
                  const BootstrappingKeyFFT<P> &bkfft,
                  const Polynomial<typename P::targetP> &testvector)
 {
-    //cout << "b " ;
-    constexpr uint32_t bitwidth = bits_needed<num_out - 1>();
-    const uint32_t bLong = 2 * P::targetP::n -
-                       ((tlwe[P::domainP::k * P::domainP::n] >>
-                         (std::numeric_limits<typename P::domainP::T>::digits -
-                          1 - P::targetP::nbit + bitwidth))
-                        << bitwidth);
+    alignas(64) RotationIndices<P> idx;
+    RotationIndicesgen<P, num_out>(idx, tlwe);
+    BlindRotate<P, num_out>(res, idx, bkfft, testvector);
+}
+
+
+// Blind rotation on the torus-domain key. Each BootstrappingKeyElement is
+// transformed into a per-thread cache right before its CMUX, so only the
+// compact key is streamed from memory, at the price of the IFFTs that
+// BootstrappingKeyFFT does once at key generation. The result equals
+// BlindRotate on the bk2bkfft of bk.
+template <class P, uint32_t num_out = 1>
+void BlindRotate(TRLWE<typename P::targetP> &res, const RotationIndices<P> &idx,
+                 const BootstrappingKey<P> &bk,
+                 const Polynomial<typename P::targetP> &testvector)
+{
+    const BlindRotateScope scope;
+    // Allocated by the first bootstrapping of each thread, rather than
+    // reserved in the TLS of every thread.
+    static thread_local std::unique_ptr<BootstrappingKeyElementFFT<P>,
+                                        decltype(&std::free)>
+        cachemem(nullptr, std::free);
+    if (!cachemem) {
+        void *mem =
+            std::aligned_alloc(64, sizeof(BootstrappingKeyElementFFT<P>));
+        if (!mem) throw std::bad_alloc();
+        cachemem.reset(new (mem) BootstrappingKeyElementFFT<P>);
+    }
+    BootstrappingKeyElementFFT<P> &cache = *cachemem;
     res = {};
-    PolynomialMulByXai<typename P::targetP>(res[P::targetP::k], testvector, bLong);
+    PolynomialMulByXai<typename P::targetP>(
+        res[P::targetP::k], testvector, idx[P::domainP::k * P::domainP::n]);
 
-    for (int i = 0; i < P::domainP::k * P::domainP::n; i++) {
-        constexpr typename P::domainP::T roundoffset =
-            1ULL << (std::numeric_limits<typename P::domainP::T>::digits - 2 -
-                     P::targetP::nbit + bitwidth);
-        const uint32_t aLong =
-            (tlwe[i] + roundoffset) >>
-            (std::numeric_limits<typename P::domainP::T>::digits - 1 -
-             P::targetP::nbit + bitwidth)
-                << bitwidth;
-        //cout << " along " << aLong << " ";
-        if (aLong == 0) continue;
-        // Do not use CMUXFFT to avoid unnecessary copy.
-        CMUXFFTwithPolynomialMulByXaiMinusOne<P>(res, bkfft[i], aLong);
+    for (int i = 0; i < P::domainP::k * P::domainP::n / P::Addends; i++) {
+        std::array<int, P::Addends> aLongs;
+        bool iszero = true;
+        for (int t = 0; t < P::Addends; t++) {
+            aLongs[t] = idx[i * P::Addends + t];
+            iszero &= aLongs[t] == 0;
+        }
+        if (iszero) {
+            blindrotatestats.cmux_skipped++;
+            continue;
+        }
+        blindrotatestats.cmux_executed++;
+        for (int count = 0; count < bkelemnum<P>(); count++)
+            ApplyFFT2trgsw<typename P::targetP>(cache[count], bk[i][count]);
+        if constexpr (P::Addends == 1)
+            CMUXFFTwithPolynomialMulByXaiMinusOne<P>(res, cache, aLongs[0]);
+        else
+            CMUXFFTwithPolynomialMulByXaiMinusOne<P>(res, cache, aLongs);
     }
 }
 
+template <class P, uint32_t num_out = 1>
+void BlindRotate(TRLWE<typename P::targetP> &res,
+                 const TLWE<typename P::domainP> &tlwe,
+                 const BootstrappingKey<P> &bk,
+                 const Polynomial<typename P::targetP> &testvector)
+{
+    alignas(64) RotationIndices<P> idx;
+    RotationIndicesgen<P, num_out>(idx, tlwe);
+    BlindRotate<P, num_out>(res, idx, bk, testvector);
+}
+
 
 template <class P, int batch, uint32_t num_out = 1>
 void BlindRotatebatch(TRLWEn<typename P::targetP, batch> &res,
@@ -50,6 +159,9 @@ void BlindRotatebatch(TRLWEn<typename P::targetP, batch> &res,
                  const BootstrappingKeyFFT<P> &bkfft,
                  const Polynomial<typename P::targetP> &testvector)
 {
+    static_assert(P::Addends == 1,
+                  "Unrolled blind rotation is not supported in batch mode!");
+    const BlindRotateScope scope;
     res = {};
     constexpr uint32_t bitwidth = bits_needed<num_out - 1>();
     for (int j = 0; j < batch; j++) {
@@ -63,20 +175,31 @@ void BlindRotatebatch(TRLWEn<typename P::targetP, batch> &res,
         PolynomialMulByXai<typename P::targetP>(res[P::targetP::k][j], testvector,
                                                 bLong);
     }
+    constexpr typename P::domainP::T roundoffset =
+        1ULL << (std::numeric_limits<typename P::domainP::T>::digits - 2 -
+                 P::targetP::nbit + bitwidth);
+    // Scratch of the CMUXes, allocated once per blind rotation.
+    std::unique_ptr<TRLWEn<typename P::targetP, batch>> temp =
+        std::make_unique<TRLWEn<typename P::targetP, batch>>();
     for (int i = 0; i < P::domainP::k * P::domainP::n; i++) {
         intArray<batch> aLongArray;
+        // Ciphertexts with a zero rotation at this index are compacted out.
+        intArray<batch> activeArray;
+        int active = 0;
         for (int j = 0; j < batch; j++) {
-            constexpr typename P::domainP::T roundoffset =
-                1ULL << (std::numeric_limits<typename P::domainP::T>::digits -
-                         2 - P::targetP::nbit + bitwidth);
             aLongArray[j] =
                 (tlwe[j][i] + roundoffset) >>
                 (std::numeric_limits<typename P::domainP::T>::digits - 1 -
                  P::targetP::nbit + bitwidth)
                     << bitwidth;
+            if (aLongArray[j] != 0) activeArray[active++] = j;
         }
+        blindrotatestats.cmux_executed += active;
+        blindrotatestats.cmux_skipped += batch - active;
+        if (active == 0) continue;
         // Do not use CMUXFFT to avoid unnecessary copy.
-        CMUXFFTwithPolynomialMulByXaiMinusOnebatch<P, batch>(res, bkfft[i], aLongArray);
+        CMUXFFTwithPolynomialMulByXaiMinusOnebatch<P, batch>(
+            res, *temp, bkfft[i], aLongArray, activeArray, active);
     }
 }
 
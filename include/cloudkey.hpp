@@ -5,8 +5,11 @@
 #include <cereal/types/memory.hpp>
 #include <cereal/types/unordered_map.hpp>
 #include <cereal/types/vector.hpp>
+#include <algorithm>
 #include <iostream>
+#include <string_view>
 #include "key.hpp"
+#include "keyalloc.hpp"
 #include "params.hpp"
 #include "tlwe.hpp"
 #include "trgsw.hpp"
@@ -15,21 +18,40 @@
 
 namespace TFHEpp {
 
+// Plaintext of the count-th TRGSW of the i-th BootstrappingKeyElement: 1 iff
+// the Addends domain key coefficients starting at i * Addends take the
+// assignment bkpatterngen<P>()[count]. With Addends = 1 this is the usual
+// indicator domainkey[i] == j.
+template <class P>
+inline typename P::targetP::T bkplaingen(
+    const Key<typename P::domainP>& domainkey, const int i, const int count)
+{
+    constexpr auto patterns = bkpatterngen<P>();
+    bool match = true;
+    for (int t = 0; t < P::Addends; t++)
+        match &= static_cast<std::make_signed_t<typename P::domainP::T>>(
+                     domainkey[i * P::Addends + t]) == patterns[count][t];
+    return match;
+}
+
+// The key generations below run their rows in parallel. Each row encrypts
+// under its own GeneratorSeed(seed, row), so the key does not depend on the
+// number of threads.
 template <class P>
 void bkgen(BootstrappingKey<P>& bk, const Key<typename P::domainP>& domainkey,
            const Key<typename P::targetP>& targetkey)
 {
-    Polynomial<typename P::targetP> plainpoly = {};
-    for (int i = 0; i < P::domainP::k * P::domainP::n; i++) {
-        int count = 0;
-        for (int j = P::domainP::key_value_min; j <= P::domainP::key_value_max;
-             j++) {
-            if (j != 0) {
-                plainpoly[0] = domainkey[i] == j;
-                bk[i][count] =
-                    trgswSymEncrypt<typename P::targetP>(plainpoly, targetkey);
-                count++;
-            }
+    static_assert((P::domainP::k * P::domainP::n) % P::Addends == 0,
+                  "Addends must divide the domain key length!");
+    const Seed seed = keygenseedgen();
+    TFHEPP_OMP(parallel for)
+    for (int i = 0; i < P::domainP::k * P::domainP::n / P::Addends; i++) {
+        GeneratorSeed rowseed(seed, i);
+        Polynomial<typename P::targetP> plainpoly = {};
+        for (int count = 0; count < bkelemnum<P>(); count++) {
+            plainpoly[0] = bkplaingen<P>(domainkey, i, count);
+            bk[i][count] =
+                trgswSymEncrypt<typename P::targetP>(plainpoly, targetkey);
         }
     }
 }
@@ -41,27 +63,34 @@ void bkgen(BootstrappingKey<P>& bk, const SecretKey& sk)
              sk.key.get<typename P::targetP>());
 }
 
+// Row i of the BootstrappingKeyFFT generated from seed. The rows of a key can
+// be generated in any order, or in pieces as by KeyGenJob.
+template <class P>
+void bkfftgenrow(BootstrappingKeyElementFFT<P>& row,
+                 const Key<typename P::domainP>& domainkey,
+                 const Key<typename P::targetP>& targetkey, const Seed& seed,
+                 const int i)
+{
+    GeneratorSeed rowseed(seed, i);
+    Polynomial<typename P::targetP> plainpoly = {};
+    for (int count = 0; count < bkelemnum<P>(); count++) {
+        plainpoly[0] = bkplaingen<P>(domainkey, i, count);
+        trgswfftSymEncrypt<typename P::targetP>(row[count], plainpoly,
+                                                targetkey);
+    }
+}
+
 template <class P>
 void bkfftgen(BootstrappingKeyFFT<P>& bkfft,
               const Key<typename P::domainP>& domainkey,
               const Key<typename P::targetP>& targetkey)
 {
-    //std::cout << std::endl << "l";
-    Polynomial<typename P::targetP> plainpoly = {};
-    for (int i = 0; i < P::domainP::k * P::domainP::n; i++) {
-        int count = 0;
-        for (int j = P::domainP::key_value_min; j <= P::domainP::key_value_max;
-             j++) {
-            if (j != 0) {
-                plainpoly[0] = domainkey[i] == j;
-                //std::cout << "p";
-                bkfft[i][count] = trgswfftSymEncrypt<typename P::targetP>(
-                    plainpoly, targetkey);
-                count++;
-            }
-        }
-    }
-    //std::cout << "q" << std::endl;
+    static_assert((P::domainP::k * P::domainP::n) % P::Addends == 0,
+                  "Addends must divide the domain key length!");
+    const Seed seed = keygenseedgen();
+    TFHEPP_OMP(parallel for)
+    for (int i = 0; i < P::domainP::k * P::domainP::n / P::Addends; i++)
+        bkfftgenrow<P>(bkfft[i], domainkey, targetkey, seed, i);
 }
 
 template <class P>
@@ -71,6 +100,74 @@ void bkfftgen(BootstrappingKeyFFT<P>& bkfft, const SecretKey& sk)
                 sk.key.get<typename P::targetP>());
 }
 
+// Transforms every TRGSW of bk into bkfft in place.
+template <class P>
+void bk2bkfft(BootstrappingKeyFFT<P>& bkfft, const BootstrappingKey<P>& bk)
+{
+    TFHEPP_OMP(parallel for)
+    for (int i = 0; i < P::domainP::k * P::domainP::n / P::Addends; i++)
+        for (int count = 0; count < bkelemnum<P>(); count++)
+            ApplyFFT2trgsw<typename P::targetP>(bkfft[i][count], bk[i][count]);
+}
+
+
+// The masks come from bk.seed, the noise from a second seed that is never
+// published, as in seededikskgen.
+template <class P>
+void seededbkgen(SeededBootstrappingKey<P>& bk,
+                 const Key<typename P::domainP>& domainkey,
+                 const Key<typename P::targetP>& targetkey)
+{
+    static_assert((P::domainP::k * P::domainP::n) % P::Addends == 0,
+                  "Addends must divide the domain key length!");
+    bk.seed = keygenseedgen(generator);
+    const Seed seed = keygenseedgen();
+    TFHEPP_OMP(parallel for)
+    for (int i = 0; i < P::domainP::k * P::domainP::n / P::Addends; i++) {
+        GeneratorSeed rowseed(seed, i);
+        Polynomial<typename P::targetP> plainpoly = {};
+        for (int count = 0; count < bkelemnum<P>(); count++) {
+            plainpoly[0] = bkplaingen<P>(domainkey, i, count);
+            trgswSymEncryptSeeded<typename P::targetP>(
+                bk.b[i][count], plainpoly, targetkey, bk.seed,
+                seededbkindex<P>(i, count, 0));
+        }
+    }
+}
+
+template <class P>
+void seededbkgen(SeededBootstrappingKey<P>& bk, const SecretKey& sk)
+{
+    seededbkgen<P>(bk, sk.key.get<typename P::domainP>(),
+                   sk.key.get<typename P::targetP>());
+}
+
+// Regenerates the masks of a SeededBootstrappingKey into a BootstrappingKey.
+template <class P>
+void bkexpand(BootstrappingKey<P>& bk, const SeededBootstrappingKey<P>& seeded)
+{
+    TFHEPP_OMP(parallel for)
+    for (int i = 0; i < P::domainP::k * P::domainP::n / P::Addends; i++)
+        for (int count = 0; count < bkelemnum<P>(); count++)
+            trgswSeededExpand<typename P::targetP>(
+                bk[i][count], seeded.b[i][count], seeded.seed,
+                seededbkindex<P>(i, count, 0));
+}
+
+// bkexpand straight into the Fourier domain, without a BootstrappingKey in
+// between.
+template <class P>
+void bkfftexpand(BootstrappingKeyFFT<P>& bkfft,
+                 const SeededBootstrappingKey<P>& seeded)
+{
+    TFHEPP_OMP(parallel for)
+    for (int i = 0; i < P::domainP::k * P::domainP::n / P::Addends; i++)
+        for (int count = 0; count < bkelemnum<P>(); count++)
+            trgswfftSeededExpand<typename P::targetP>(
+                bkfft[i][count], seeded.b[i][count], seeded.seed,
+                seededbkindex<P>(i, count, 0));
+}
+
 
 
 
@@ -79,7 +176,10 @@ void tlwe2trlweikskgen(TLWE2TRLWEIKSKey<P>& iksk,
                        const Key<typename P::domainP>& domainkey,
                        const Key<typename P::targetP>& targetkey)
 {
-    for (int i = 0; i < P::domainP::n; i++)
+    const Seed seed = keygenseedgen();
+    TFHEPP_OMP(parallel for)
+    for (int i = 0; i < P::domainP::n; i++) {
+        GeneratorSeed rowseed(seed, i);
         for (int j = 0; j < P::t; j++)
             for (uint32_t k = 0; k < (1 << P::basebit) - 1; k++) {
                 Polynomial<typename P::targetP> p = {};
@@ -90,6 +190,7 @@ void tlwe2trlweikskgen(TLWE2TRLWEIKSKey<P>& iksk,
                 iksk[i][j][k] =
                     trlweSymEncrypt<typename P::targetP>(p, targetkey);
             }
+    }
 }
 
 template <class P>
@@ -102,12 +203,15 @@ void tlwe2trlweikskgen(TLWE2TRLWEIKSKey<P>& iksk, const SecretKey& sk)
 template <class P>
 void annihilatekeygen(AnnihilateKey<P>& ahk, const Key<P>& key)
 {
+    std::array<typename P::T, P::n> partkey;
+    for (int i = 0; i < P::n; i++) partkey[i] = key[0 * P::n + i];
+    const Seed seed = keygenseedgen();
+    TFHEPP_OMP(parallel for)
     for (int i = 0; i < P::nbit; i++) {
+        GeneratorSeed rowseed(seed, i);
         Polynomial<P> autokey;
-        std::array<typename P::T, P::n> partkey;
-        for (int i = 0; i < P::n; i++) partkey[i] = key[0 * P::n + i];
         Automorphism<P>(autokey, partkey, (1 << (P::nbit - i)) + 1);
-        ahk[i] = trgswfftSymEncrypt<P>(autokey, key);
+        trgswfftSymEncrypt<P>(ahk[i], autokey, key);
     }
 }
 
@@ -117,21 +221,30 @@ void annihilatekeygen(AnnihilateKey<P>& ahk, const SecretKey& sk)
     annihilatekeygen<P>(ahk, sk.key.get<P>());
 }
 
+template <class P>
+void ikskgenrow(typename KeySwitchingKey<P>::value_type& row,
+                const Key<typename P::domainP>& domainkey,
+                const Key<typename P::targetP>& targetkey, const Seed& seed,
+                const int i)
+{
+    GeneratorSeed rowseed(seed, i);
+    for (int j = 0; j < P::t; j++)
+        for (uint32_t k = 0; k < (1 << P::basebit) - 1; k++)
+            row[j][k] = tlweSymEncrypt<typename P::targetP>(
+                domainkey[i] * (k + 1) *
+                    (1ULL << (numeric_limits<typename P::targetP::T>::digits -
+                              (j + 1) * P::basebit)),
+                targetkey);
+}
+
 template <class P>
 void ikskgen(KeySwitchingKey<P>& ksk, const Key<typename P::domainP>& domainkey,
              const Key<typename P::targetP>& targetkey)
 {
-    for (int l = 0; l < P::domainP::k; l++)
-        for (int i = 0; i < P::domainP::n; i++)
-            for (int j = 0; j < P::t; j++)
-                for (uint32_t k = 0; k < (1 << P::basebit) - 1; k++)
-                    ksk[l * P::domainP::n + i][j][k] =
-                        tlweSymEncrypt<typename P::targetP>(
-                            domainkey[l * P::domainP::n + i] * (k + 1) *
-                                (1ULL << (numeric_limits<
-                                              typename P::targetP::T>::digits -
-                                          (j + 1) * P::basebit)),
-                            targetkey);
+    const Seed seed = keygenseedgen();
+    TFHEPP_OMP(parallel for)
+    for (int i = 0; i < P::domainP::k * P::domainP::n; i++)
+        ikskgenrow<P>(ksk[i], domainkey, targetkey, seed, i);
 }
 
 template <class P>
@@ -141,30 +254,203 @@ void ikskgen(KeySwitchingKey<P>& ksk, const SecretKey& sk)
                sk.key.get<typename P::targetP>());
 }
 
+template <class P>
+void seededikskgen(SeededKeySwitchingKey<P>& ksk,
+                   const Key<typename P::domainP>& domainkey,
+                   const Key<typename P::targetP>& targetkey)
+{
+    // The masks come from ksk.seed, the noise from a second seed that is
+    // never published.
+    ksk.seed = keygenseedgen(generator);
+    const Seed seed = keygenseedgen();
+    TFHEPP_OMP(parallel for)
+    for (int i = 0; i < P::domainP::k * P::domainP::n; i++) {
+        GeneratorSeed rowseed(seed, i);
+        for (int j = 0; j < P::t; j++)
+            for (uint32_t k = 0; k < (1 << P::basebit) - 1; k++)
+                ksk.b[i][j][k] = tlweSymEncryptSeeded<typename P::targetP>(
+                    domainkey[i] * (k + 1) *
+                        (1ULL
+                         << (numeric_limits<typename P::targetP::T>::digits -
+                             (j + 1) * P::basebit)),
+                    targetkey, ksk.seed,
+                    seededksindex<P>(i, j, k))[P::targetP::k * P::targetP::n];
+    }
+}
+
+template <class P>
+void seededikskgen(SeededKeySwitchingKey<P>& ksk, const SecretKey& sk)
+{
+    seededikskgen<P>(ksk, sk.key.get<typename P::domainP>(),
+                     sk.key.get<typename P::targetP>());
+}
+
+// Regenerates the masks of a SeededKeySwitchingKey into a KeySwitchingKey.
+template <class P>
+void ikskexpand(KeySwitchingKey<P>& ksk, const SeededKeySwitchingKey<P>& seeded)
+{
+    TFHEPP_OMP(parallel for)
+    for (int i = 0; i < P::domainP::k * P::domainP::n; i++)
+        for (int j = 0; j < P::t; j++)
+            for (uint32_t k = 0; k < (1 << P::basebit) - 1; k++) {
+                tlweSeededMask<typename P::targetP>(
+                    ksk[i][j][k], seeded.seed, seededksindex<P>(i, j, k));
+                ksk[i][j][k][P::targetP::k * P::targetP::n] =
+                    seeded.b[i][j][k];
+            }
+}
+
+template <class P>
+void packedikskgen(PackedKeySwitchingKey<P>& ksk,
+                   const Key<typename P::domainP>& domainkey,
+                   const Key<typename P::targetP>& targetkey)
+{
+    const Seed seed = keygenseedgen();
+    TFHEPP_OMP(parallel for)
+    for (int i = 0; i < P::domainP::k * P::domainP::n; i++) {
+        GeneratorSeed rowseed(seed, i);
+        for (int j = 0; j < P::t; j++)
+            for (uint32_t k = 0; k < (1 << P::basebit) - 1; k++) {
+                const TLWE<typename P::targetP> c =
+                    tlweSymEncrypt<typename P::targetP>(
+                        domainkey[i] * (k + 1) *
+                            (1ULL << (numeric_limits<
+                                          typename P::targetP::T>::digits -
+                                      (j + 1) * P::basebit)),
+                        targetkey);
+                PackedKeySwitchingKeyRow<P>& row = ksk[i][j][k];
+                row = {};
+                std::copy(c.begin(), c.end(), row.begin());
+            }
+    }
+}
+
+template <class P>
+void packedikskgen(PackedKeySwitchingKey<P>& ksk, const SecretKey& sk)
+{
+    packedikskgen<P>(ksk, sk.key.get<typename P::domainP>(),
+                     sk.key.get<typename P::targetP>());
+}
+
+// Converts a KeySwitchingKey into the packed layout.
+template <class P>
+void ikskpack(PackedKeySwitchingKey<P>& packed, const KeySwitchingKey<P>& ksk)
+{
+    TFHEPP_OMP(parallel for)
+    for (int i = 0; i < P::domainP::k * P::domainP::n; i++)
+        for (int j = 0; j < P::t; j++)
+            for (uint32_t k = 0; k < (1 << P::basebit) - 1; k++) {
+                packed[i][j][k] = {};
+                std::copy(ksk[i][j][k].begin(), ksk[i][j][k].end(),
+                          packed[i][j][k].begin());
+            }
+}
+
+// Stores the top bits bits of every coefficient of c, rounded to nearest with
+// ties to even. The errors of the rows add up in the key switch, so the
+// rounding must not be biased.
+template <class P, uint32_t bits>
+void quantizedksrowgen(QuantizedKeySwitchingKeyRow<P, bits>& row,
+                       const TLWE<typename P::targetP>& c)
+{
+    using Row = QuantizedKeySwitchingKeyRow<P, bits>;
+    constexpr uint32_t shift = Row::digits - bits;
+    row.lo = {};
+    for (uint32_t l = 0; l < Row::len; l++) {
+        const uint64_t v = c[l];
+        const uint64_t q =
+            (v + (1ULL << (shift - 1)) - 1 + ((v >> shift) & 1)) >> shift;
+        if constexpr (Row::hibits != 0)
+            row.hi[l] = q >> (bits - Row::hibits);
+        if constexpr (Row::midbits != 0)
+            row.mid[l] = q >> Row::lobits;
+        if constexpr (Row::lobits != 0) {
+            if (l < Row::half)
+                row.lo[l] |= q & 0xF;
+            else
+                row.lo[l - Row::half] |= (q & 0xF) << 4;
+        }
+    }
+}
+
+template <class P, uint32_t bits = P::quantizedbits>
+void quantizedikskgen(QuantizedKeySwitchingKey<P, bits>& ksk,
+                      const Key<typename P::domainP>& domainkey,
+                      const Key<typename P::targetP>& targetkey)
+{
+    const Seed seed = keygenseedgen();
+    TFHEPP_OMP(parallel for)
+    for (int i = 0; i < P::domainP::k * P::domainP::n; i++) {
+        GeneratorSeed rowseed(seed, i);
+        for (int j = 0; j < P::t; j++)
+            for (uint32_t k = 0; k < (1 << P::basebit) - 1; k++)
+                quantizedksrowgen<P, bits>(
+                    ksk[i][j][k],
+                    tlweSymEncrypt<typename P::targetP>(
+                        domainkey[i] * (k + 1) *
+                            (1ULL << (numeric_limits<
+                                          typename P::targetP::T>::digits -
+                                      (j + 1) * P::basebit)),
+                        targetkey));
+    }
+}
+
+template <class P, uint32_t bits = P::quantizedbits>
+void quantizedikskgen(QuantizedKeySwitchingKey<P, bits>& ksk,
+                      const SecretKey& sk)
+{
+    quantizedikskgen<P, bits>(ksk, sk.key.get<typename P::domainP>(),
+                              sk.key.get<typename P::targetP>());
+}
+
+// Converts a KeySwitchingKey into the quantized layout.
+template <class P, uint32_t bits = P::quantizedbits>
+void ikskquantize(QuantizedKeySwitchingKey<P, bits>& quantized,
+                  const KeySwitchingKey<P>& ksk)
+{
+    TFHEPP_OMP(parallel for)
+    for (int i = 0; i < P::domainP::k * P::domainP::n; i++)
+        for (int j = 0; j < P::t; j++)
+            for (uint32_t k = 0; k < (1 << P::basebit) - 1; k++)
+                quantizedksrowgen<P, bits>(quantized[i][j][k], ksk[i][j][k]);
+}
+
+// Row i of a PrivateKeySwitchingKey. The last row, for the body of the
+// switched ciphertext, has key coefficient -1.
+template <class P>
+void privkskgenrow(typename PrivateKeySwitchingKey<P>::value_type& row,
+                   const Polynomial<typename P::targetP>& func,
+                   const Key<typename P::domainP>& domainkey,
+                   const Key<typename P::targetP>& targetkey, const Seed& seed,
+                   const int i)
+{
+    const typename P::domainP::T key =
+        i < P::domainP::k * P::domainP::n ? domainkey[i] : -1;
+    for (int j = 0; j < P::t; j++)
+        for (typename P::targetP::T u = 0; u < (1 << P::basebit) - 1; u++) {
+            GeneratorSeed rowseed(
+                seed, (i * P::t + j) * ((1 << P::basebit) - 1) + u);
+            TRLWE<typename P::targetP> c =
+                trlweSymEncryptZero<typename P::targetP>(targetkey);
+            for (int k = 0; k < P::targetP::n; k++)
+                c[P::targetP::k][k] +=
+                    (u + 1) * func[k] * key
+                    << (numeric_limits<typename P::targetP::T>::digits -
+                        (j + 1) * P::basebit);
+            row[j][u] = c;
+        }
+}
+
 template <class P>
 void privkskgen(PrivateKeySwitchingKey<P>& privksk,
                 const Polynomial<typename P::targetP>& func,
                 const Key<typename P::domainP>& domainkey,
                 const Key<typename P::targetP>& targetkey)
 {
-    //std::cout << "i";
-    std::array<typename P::domainP::T, P::domainP::k * P::domainP::n + 1> key;
-    for (int i = 0; i < P::domainP::k * P::domainP::n; i++)
-        key[i] = domainkey[i];
-    key[P::domainP::k * P::domainP::n] = -1;
-#pragma omp parallel for collapse(3)
+    const Seed seed = keygenseedgen();
+    TFHEPP_OMP(parallel for)
     for (int i = 0; i <= P::domainP::k * P::domainP::n; i++)
-        for (int j = 0; j < P::t; j++)
-            for (typename P::targetP::T u = 0; u < (1 << P::basebit) - 1; u++) {
-                TRLWE<typename P::targetP> c =
-                    trlweSymEncryptZero<typename P::targetP>(targetkey);
-                for (int k = 0; k < P::targetP::n; k++)
-                    c[P::targetP::k][k] +=
-                        (u + 1) * func[k] * key[i]
-                        << (numeric_limits<typename P::targetP::T>::digits -
-                            (j + 1) * P::basebit);
-                privksk[i][j][u] = c;
-            }
+        privkskgenrow<P>(privksk[i], func, domainkey, targetkey, seed, i);
 }
 
 template <class P>
@@ -182,8 +468,12 @@ void subikskgen(SubsetKeySwitchingKey<P>& ksk,
 {
     Key<typename P::targetP> subkey;
     for (int i = 0; i < P::targetP::n; i++) subkey[i] = domainkey[i];
+    const Seed seed = keygenseedgen();
+    TFHEPP_OMP(parallel for)
     for (int i = 0;
-         i < P::domainP::k * P::domainP::n - P::targetP::k * P::targetP::n; i++)
+         i < P::domainP::k * P::domainP::n - P::targetP::k * P::targetP::n;
+         i++) {
+        GeneratorSeed rowseed(seed, i);
         for (int j = 0; j < P::t; j++)
             for (uint32_t k = 0; k < (1 << P::basebit) - 1; k++)
                 ksk[i][j][k] = tlweSymEncrypt<typename P::targetP>(
@@ -192,6 +482,7 @@ void subikskgen(SubsetKeySwitchingKey<P>& ksk,
                          << (numeric_limits<typename P::targetP::T>::digits -
                              (j + 1) * P::basebit)),
                     subkey);
+    }
 }
 
 template <class P>
@@ -228,10 +519,13 @@ void subprivkskgen(SubsetPrivateKeySwitchingKey<P>& privksk,
     for (int i = 0; i < P::targetP::k * P::targetP::n; i++)
         key[i] = domainkey[i];
     key[P::targetP::k * P::targetP::n] = -1;
-#pragma omp parallel for collapse(3)
+    const Seed seed = keygenseedgen();
+    TFHEPP_OMP(parallel for collapse(3))
     for (int i = 0; i <= P::targetP::k * P::targetP::n; i++)
         for (int j = 0; j < P::t; j++)
             for (typename P::targetP::T u = 0; u < (1 << P::basebit) - 1; u++) {
+                GeneratorSeed rowseed(
+                    seed, (i * P::t + j) * ((1 << P::basebit) - 1) + u);
                 TRLWE<typename P::targetP> c =
                     trlweSymEncryptZero<typename P::targetP>(targetkey);
                 for (int k = 0; k < P::targetP::n; k++)
@@ -264,6 +558,11 @@ relinKeyFFT<P> relinKeyFFTgen(const Key<P>& key)
     return relinkeyfft;
 }
 
+class EvalKeyFile;
+// EvalKeyFile::get, see evalkeyfile.hpp.
+void* evalkeyfileload(EvalKeyFile& file, std::string_view member,
+                      std::string_view key, uint64_t size);
+
 struct EvalKey {
     lweParams params;
     // BootstrapingKey
@@ -276,11 +575,20 @@ struct EvalKey {
     std::shared_ptr<BootstrappingKeyFFT<lvlh1param>> bkfftlvlh1;
     std::shared_ptr<BootstrappingKeyFFT<lvl02param>> bkfftlvl02;
     std::shared_ptr<BootstrappingKeyFFT<lvlh2param>> bkfftlvlh2;
+    // Unrolled BoostrappingKeyFFT
+    std::shared_ptr<BootstrappingKeyFFT<lvl01Addends2param>> bkfftlvl01addends2;
+    std::shared_ptr<BootstrappingKeyFFT<lvl01Addends3param>> bkfftlvl01addends3;
+    std::shared_ptr<BootstrappingKeyFFT<lvl02Addends2param>> bkfftlvl02addends2;
     // BootstrappingKeyNTT
     std::shared_ptr<BootstrappingKeyFFT<lvl01param>> bknttlvl01;
     std::shared_ptr<BootstrappingKeyFFT<lvlh1param>> bknttlvlh1;
     std::shared_ptr<BootstrappingKeyFFT<lvl02param>> bknttlvl02;
     std::shared_ptr<BootstrappingKeyFFT<lvlh2param>> bknttlvlh2;
+    // SeededBootstrappingKey
+    std::shared_ptr<SeededBootstrappingKey<lvl01param>> seedbklvl01;
+    std::shared_ptr<SeededBootstrappingKey<lvlh1param>> seedbklvlh1;
+    std::shared_ptr<SeededBootstrappingKey<lvl02param>> seedbklvl02;
+    std::shared_ptr<SeededBootstrappingKey<lvlh2param>> seedbklvlh2;
     // KeySwitchingKey
     std::shared_ptr<KeySwitchingKey<lvl10param>> iksklvl10;
     std::shared_ptr<KeySwitchingKey<lvl1hparam>> iksklvl1h;
@@ -288,6 +596,19 @@ struct EvalKey {
     std::shared_ptr<KeySwitchingKey<lvl21param>> iksklvl21;
     std::shared_ptr<KeySwitchingKey<lvl22param>> iksklvl22;
     std::shared_ptr<KeySwitchingKey<lvl31param>> iksklvl31;
+    // PackedKeySwitchingKey
+    std::shared_ptr<PackedKeySwitchingKey<lvl10param>> packediksklvl10;
+    std::shared_ptr<PackedKeySwitchingKey<lvl1hparam>> packediksklvl1h;
+    std::shared_ptr<PackedKeySwitchingKey<lvl20param>> packediksklvl20;
+    std::shared_ptr<PackedKeySwitchingKey<lvl21param>> packediksklvl21;
+    // SeededKeySwitchingKey
+    std::shared_ptr<SeededKeySwitchingKey<lvl10param>> seediksklvl10;
+    std::shared_ptr<SeededKeySwitchingKey<lvl1hparam>> seediksklvl1h;
+    std::shared_ptr<SeededKeySwitchingKey<lvl20param>> seediksklvl20;
+    std::shared_ptr<SeededKeySwitchingKey<lvl21param>> seediksklvl21;
+    // AnnihilateKey
+    std::shared_ptr<AnnihilateKey<lvl1param>> ahklvl1;
+    std::shared_ptr<AnnihilateKey<lvl2param>> ahklvl2;
     // SubsetKeySwitchingKey
     std::shared_ptr<SubsetKeySwitchingKey<lvl21param>> subiksklvl21;
     // PrivateKeySwitchingKey
@@ -304,18 +625,71 @@ struct EvalKey {
     std::unordered_map<
         std::string, std::shared_ptr<SubsetPrivateKeySwitchingKey<lvl21param>>>
         subprivksklvl21;
+    // Source of the keys left empty above, loaded on their first get*.
+    std::shared_ptr<EvalKeyFile> keyfile;
+    // Pages of the keys emplaced from now on, and what each key got.
+    KeyAllocPolicy allocpolicy;
+    std::vector<KeyAllocation> allocations;
 
     EvalKey(SecretKey sk) { params = sk.params; }
     EvalKey() {}
 
+    // Calls f(name, member) for every key member, named as the member. The
+    // order is fixed, so it can define file layouts (see evalkeyfile.hpp).
+    template <class F>
+    void foreachkey(F&& f)
+    {
+        foreachkeyof(*this, f);
+    }
+    template <class F>
+    void foreachkey(F&& f) const
+    {
+        foreachkeyof(*this, f);
+    }
+
+    // Version 1 archives every key. Archives of earlier builds have no class
+    // version and hold only the keys up to privksklvl22. They start with
+    // params, so the word cereal reads as their version is lweParams::lvl0.n,
+    // which is never 1. cereal reads the version once per archive, so only
+    // one such EvalKey per archive loads.
+    template <class Archive>
+    void save(Archive& archive,
+              [[maybe_unused]] const std::uint32_t version) const
+    {
+        archive(params, bklvl01, bklvlh1, bklvl02, bklvlh2, bkfftlvl01,
+                bkfftlvlh1, bkfftlvl02, bkfftlvlh2, bknttlvl01, bknttlvlh1,
+                bknttlvl02, bknttlvlh2, iksklvl10, iksklvl1h, iksklvl20,
+                iksklvl21, iksklvl22, iksklvl31, privksklvl11, privksklvl21,
+                privksklvl22, bkfftlvl01addends2, bkfftlvl01addends3,
+                bkfftlvl02addends2, packediksklvl10, packediksklvl1h,
+                packediksklvl20, packediksklvl21, seediksklvl10,
+                seediksklvl1h, seediksklvl20, seediksklvl21, ahklvl1,
+                ahklvl2, seedbklvl01, seedbklvlh1, seedbklvl02,
+                seedbklvlh2);
+    }
     template <class Archive>
-    void serialize(Archive& archive)
+    void load(Archive& archive, const std::uint32_t version)
     {
+        if (version != 1) {
+            params.lvl0.n = version;
+            params.serializeafterlvl0n(archive);
+            archive(bklvl01, bklvlh1, bklvl02, bklvlh2, bkfftlvl01,
+                    bkfftlvlh1, bkfftlvl02, bkfftlvlh2, bknttlvl01,
+                    bknttlvlh1, bknttlvl02, bknttlvlh2, iksklvl10, iksklvl1h,
+                    iksklvl20, iksklvl21, iksklvl22, iksklvl31, privksklvl11,
+                    privksklvl21, privksklvl22);
+            return;
+        }
         archive(params, bklvl01, bklvlh1, bklvl02, bklvlh2, bkfftlvl01,
                 bkfftlvlh1, bkfftlvl02, bkfftlvlh2, bknttlvl01, bknttlvlh1,
                 bknttlvl02, bknttlvlh2, iksklvl10, iksklvl1h, iksklvl20,
                 iksklvl21, iksklvl22, iksklvl31, privksklvl11, privksklvl21,
-                privksklvl22);
+                privksklvl22, bkfftlvl01addends2, bkfftlvl01addends3,
+                bkfftlvl02addends2, packediksklvl10, packediksklvl1h,
+                packediksklvl20, packediksklvl21, seediksklvl10,
+                seediksklvl1h, seediksklvl20, seediksklvl21, ahklvl1,
+                ahklvl2, seedbklvl01, seedbklvlh1, seedbklvl02,
+                seedbklvlh2);
     }
 
     // emplace keys
@@ -323,23 +697,19 @@ struct EvalKey {
     void emplacebk(const SecretKey& sk)
     {
         if constexpr (std::is_same_v<P, lvl01param>) {
-            bklvl01 =
-                std::make_unique<BootstrappingKey<lvl01param>>();
+            bklvl01 = allocatekey<BootstrappingKey<lvl01param>>("bklvl01");
             bkgen<lvl01param>(*bklvl01, sk);
         }
         else if constexpr (std::is_same_v<P, lvlh1param>) {
-            bklvlh1 =
-                std::make_unique<BootstrappingKey<lvlh1param>>();
+            bklvlh1 = allocatekey<BootstrappingKey<lvlh1param>>("bklvlh1");
             bkgen<lvlh1param>(*bklvlh1, sk);
         }
         else if constexpr (std::is_same_v<P, lvl02param>) {
-            bklvl02 =
-                std::make_unique<BootstrappingKey<lvl02param>>();
+            bklvl02 = allocatekey<BootstrappingKey<lvl02param>>("bklvl02");
             bkgen<lvl02param>(*bklvl02, sk);
         }
         else if constexpr (std::is_same_v<P, lvlh2param>) {
-            bklvlh2 =
-                std::make_unique<BootstrappingKey<lvlh2param>>();
+            bklvlh2 = allocatekey<BootstrappingKey<lvlh2param>>("bklvlh2");
             bkgen<lvlh2param>(*bklvlh2, sk);
         }
         else
@@ -350,25 +720,43 @@ struct EvalKey {
     {
         //std::cout << "m";
         if constexpr (std::is_same_v<P, lvl01param>) {
-            bkfftlvl01 = std::unique_ptr<BootstrappingKeyFFT<lvl01param>>(
-                new (std::align_val_t(64)) BootstrappingKeyFFT<lvl01param>());
+            bkfftlvl01 =
+                allocatekey<BootstrappingKeyFFT<lvl01param>>("bkfftlvl01");
             bkfftgen<lvl01param>(*bkfftlvl01, sk);
         }
         else if constexpr (std::is_same_v<P, lvlh1param>) {
-            bkfftlvlh1 = std::unique_ptr<BootstrappingKeyFFT<lvlh1param>>(
-                new (std::align_val_t(64)) BootstrappingKeyFFT<lvlh1param>());
+            bkfftlvlh1 =
+                allocatekey<BootstrappingKeyFFT<lvlh1param>>("bkfftlvlh1");
             bkfftgen<lvlh1param>(*bkfftlvlh1, sk);
         }
         else if constexpr (std::is_same_v<P, lvl02param>) {
-            bkfftlvl02 = std::unique_ptr<BootstrappingKeyFFT<lvl02param>>(
-                new (std::align_val_t(64)) BootstrappingKeyFFT<lvl02param>());
+            bkfftlvl02 =
+                allocatekey<BootstrappingKeyFFT<lvl02param>>("bkfftlvl02");
             bkfftgen<lvl02param>(*bkfftlvl02, sk);
         }
         else if constexpr (std::is_same_v<P, lvlh2param>) {
-            bkfftlvlh2 = std::unique_ptr<BootstrappingKeyFFT<lvlh2param>>(
-                new (std::align_val_t(64)) BootstrappingKeyFFT<lvlh2param>());
+            bkfftlvlh2 =
+                allocatekey<BootstrappingKeyFFT<lvlh2param>>("bkfftlvlh2");
             bkfftgen<lvlh2param>(*bkfftlvlh2, sk);
         }
+        else if constexpr (std::is_same_v<P, lvl01Addends2param>) {
+            bkfftlvl01addends2 =
+                allocatekey<BootstrappingKeyFFT<lvl01Addends2param>>(
+                    "bkfftlvl01addends2");
+            bkfftgen<lvl01Addends2param>(*bkfftlvl01addends2, sk);
+        }
+        else if constexpr (std::is_same_v<P, lvl01Addends3param>) {
+            bkfftlvl01addends3 =
+                allocatekey<BootstrappingKeyFFT<lvl01Addends3param>>(
+                    "bkfftlvl01addends3");
+            bkfftgen<lvl01Addends3param>(*bkfftlvl01addends3, sk);
+        }
+        else if constexpr (std::is_same_v<P, lvl02Addends2param>) {
+            bkfftlvl02addends2 =
+                allocatekey<BootstrappingKeyFFT<lvl02Addends2param>>(
+                    "bkfftlvl02addends2");
+            bkfftgen<lvl02Addends2param>(*bkfftlvl02addends2, sk);
+        }
         else
             static_assert(false_v<typename P::T>, "Not predefined parameter!");
     }
@@ -376,34 +764,80 @@ struct EvalKey {
     template <class P>
     void emplacebk2bkfft()
     {
-        //std::cout << " emplacebk2bkfft ";
         if constexpr (std::is_same_v<P, lvl01param>) {
-            bkfftlvl01 = std::make_unique<
-                BootstrappingKeyFFT<lvl01param>>();
-            for (int i = 0; i < lvl01param::domainP::n; i++)
-                (*bkfftlvl01)[i][0] =
-                    ApplyFFT2trgsw<lvl1param>((*bklvl01)[i][0]);
+            bkfftlvl01 =
+                allocatekey<BootstrappingKeyFFT<lvl01param>>("bkfftlvl01");
+            bk2bkfft<lvl01param>(*bkfftlvl01, getbk<lvl01param>());
         }
         else if constexpr (std::is_same_v<P, lvlh1param>) {
-            bkfftlvlh1 = std::make_unique<
-                BootstrappingKeyFFT<lvlh1param>>();
-            for (int i = 0; i < lvlh1param::domainP::n; i++)
-                (*bkfftlvlh1)[i][0] =
-                    ApplyFFT2trgsw<lvl1param>((*bklvlh1)[i][0]);
+            bkfftlvlh1 =
+                allocatekey<BootstrappingKeyFFT<lvlh1param>>("bkfftlvlh1");
+            bk2bkfft<lvlh1param>(*bkfftlvlh1, getbk<lvlh1param>());
         }
         else if constexpr (std::is_same_v<P, lvl02param>) {
-            bkfftlvl02 = std::make_unique<
-                BootstrappingKeyFFT<lvl02param>>();
-            for (int i = 0; i < lvl02param::domainP::n; i++)
-                (*bkfftlvl02)[i][0] =
-                    ApplyFFT2trgsw<lvl2param>((*bklvl02)[i][0]);
+            bkfftlvl02 =
+                allocatekey<BootstrappingKeyFFT<lvl02param>>("bkfftlvl02");
+            bk2bkfft<lvl02param>(*bkfftlvl02, getbk<lvl02param>());
         }
         else if constexpr (std::is_same_v<P, lvlh2param>) {
-            bkfftlvlh2 = std::make_unique<
-                BootstrappingKeyFFT<lvlh2param>>();
-            for (int i = 0; i < lvlh2param::domainP::n; i++)
-                (*bkfftlvlh2)[i][0] =
-                    ApplyFFT2trgsw<lvl2param>((*bklvlh2)[i][0]);
+            bkfftlvlh2 =
+                allocatekey<BootstrappingKeyFFT<lvlh2param>>("bkfftlvlh2");
+            bk2bkfft<lvlh2param>(*bkfftlvlh2, getbk<lvlh2param>());
+        }
+        else
+            static_assert(false_v<typename P::T>, "Not predefined parameter!");
+    }
+
+    template <class P>
+    void emplaceseedbk(const SecretKey& sk)
+    {
+        if constexpr (std::is_same_v<P, lvl01param>) {
+            seedbklvl01 = allocatekey<SeededBootstrappingKey<lvl01param>>(
+                "seedbklvl01");
+            seededbkgen<lvl01param>(*seedbklvl01, sk);
+        }
+        else if constexpr (std::is_same_v<P, lvlh1param>) {
+            seedbklvlh1 = allocatekey<SeededBootstrappingKey<lvlh1param>>(
+                "seedbklvlh1");
+            seededbkgen<lvlh1param>(*seedbklvlh1, sk);
+        }
+        else if constexpr (std::is_same_v<P, lvl02param>) {
+            seedbklvl02 = allocatekey<SeededBootstrappingKey<lvl02param>>(
+                "seedbklvl02");
+            seededbkgen<lvl02param>(*seedbklvl02, sk);
+        }
+        else if constexpr (std::is_same_v<P, lvlh2param>) {
+            seedbklvlh2 = allocatekey<SeededBootstrappingKey<lvlh2param>>(
+                "seedbklvlh2");
+            seededbkgen<lvlh2param>(*seedbklvlh2, sk);
+        }
+        else
+            static_assert(false_v<typename P::T>, "Not predefined parameter!");
+    }
+    // Expands the seeded key into the key used by the blind rotation, e.g.
+    // right after receiving it from the client.
+    template <class P>
+    void emplaceseedbk2bkfft()
+    {
+        if constexpr (std::is_same_v<P, lvl01param>) {
+            bkfftlvl01 =
+                allocatekey<BootstrappingKeyFFT<lvl01param>>("bkfftlvl01");
+            bkfftexpand<lvl01param>(*bkfftlvl01, getseedbk<lvl01param>());
+        }
+        else if constexpr (std::is_same_v<P, lvlh1param>) {
+            bkfftlvlh1 =
+                allocatekey<BootstrappingKeyFFT<lvlh1param>>("bkfftlvlh1");
+            bkfftexpand<lvlh1param>(*bkfftlvlh1, getseedbk<lvlh1param>());
+        }
+        else if constexpr (std::is_same_v<P, lvl02param>) {
+            bkfftlvl02 =
+                allocatekey<BootstrappingKeyFFT<lvl02param>>("bkfftlvl02");
+            bkfftexpand<lvl02param>(*bkfftlvl02, getseedbk<lvl02param>());
+        }
+        else if constexpr (std::is_same_v<P, lvlh2param>) {
+            bkfftlvlh2 =
+                allocatekey<BootstrappingKeyFFT<lvlh2param>>("bkfftlvlh2");
+            bkfftexpand<lvlh2param>(*bkfftlvlh2, getseedbk<lvlh2param>());
         }
         else
             static_assert(false_v<typename P::T>, "Not predefined parameter!");
@@ -413,18 +847,15 @@ struct EvalKey {
     void emplaceiksk(const SecretKey& sk)
     {
         if constexpr (std::is_same_v<P, lvl10param>) {
-            iksklvl10 = std::unique_ptr<KeySwitchingKey<lvl10param>>(
-                new (std::align_val_t(64)) KeySwitchingKey<lvl10param>());
+            iksklvl10 = allocatekey<KeySwitchingKey<lvl10param>>("iksklvl10");
             ikskgen<lvl10param>(*iksklvl10, sk);
         }
         else if constexpr (std::is_same_v<P, lvl1hparam>) {
-            iksklvl1h = std::unique_ptr<KeySwitchingKey<lvl1hparam>>(
-                new (std::align_val_t(64)) KeySwitchingKey<lvl1hparam>());
+            iksklvl1h = allocatekey<KeySwitchingKey<lvl1hparam>>("iksklvl1h");
             ikskgen<lvl1hparam>(*iksklvl1h, sk);
         }
         else if constexpr (std::is_same_v<P, lvl20param>) {
-            iksklvl20 = std::unique_ptr<KeySwitchingKey<lvl20param>>(
-                new (std::align_val_t(64)) KeySwitchingKey<lvl20param>());
+            iksklvl20 = allocatekey<KeySwitchingKey<lvl20param>>("iksklvl20");
             ikskgen<lvl20param>(*iksklvl20, sk);
         }
         // else if constexpr (std::is_same_v<P, lvl2hparam>) {
@@ -433,29 +864,142 @@ struct EvalKey {
         //     ikskgen<lvlh2param>(*iksklvlh2, sk);
         // }
         else if constexpr (std::is_same_v<P, lvl21param>) {
-            iksklvl21 = std::unique_ptr<KeySwitchingKey<lvl21param>>(
-                new (std::align_val_t(64)) KeySwitchingKey<lvl21param>());
+            iksklvl21 = allocatekey<KeySwitchingKey<lvl21param>>("iksklvl21");
             ikskgen<lvl21param>(*iksklvl21, sk);
         }
         else if constexpr (std::is_same_v<P, lvl22param>) {
-            iksklvl22 = std::unique_ptr<KeySwitchingKey<lvl22param>>(
-                new (std::align_val_t(64)) KeySwitchingKey<lvl22param>());
+            iksklvl22 = allocatekey<KeySwitchingKey<lvl22param>>("iksklvl22");
             ikskgen<lvl22param>(*iksklvl22, sk);
         }
         else if constexpr (std::is_same_v<P, lvl31param>) {
-            iksklvl31 = std::unique_ptr<KeySwitchingKey<lvl31param>>(
-                new (std::align_val_t(64)) KeySwitchingKey<lvl31param>());
+            iksklvl31 = allocatekey<KeySwitchingKey<lvl31param>>("iksklvl31");
             ikskgen<lvl31param>(*iksklvl31, sk);
         }
         else
             static_assert(false_v<typename P::T>, "Not predefined parameter!");
     }
     template <class P>
+    void emplacepackediksk(const SecretKey& sk)
+    {
+        if constexpr (std::is_same_v<P, lvl10param>) {
+            packediksklvl10 = allocatekey<PackedKeySwitchingKey<lvl10param>>(
+                "packediksklvl10");
+            packedikskgen<lvl10param>(*packediksklvl10, sk);
+        }
+        else if constexpr (std::is_same_v<P, lvl1hparam>) {
+            packediksklvl1h = allocatekey<PackedKeySwitchingKey<lvl1hparam>>(
+                "packediksklvl1h");
+            packedikskgen<lvl1hparam>(*packediksklvl1h, sk);
+        }
+        else if constexpr (std::is_same_v<P, lvl20param>) {
+            packediksklvl20 = allocatekey<PackedKeySwitchingKey<lvl20param>>(
+                "packediksklvl20");
+            packedikskgen<lvl20param>(*packediksklvl20, sk);
+        }
+        else if constexpr (std::is_same_v<P, lvl21param>) {
+            packediksklvl21 = allocatekey<PackedKeySwitchingKey<lvl21param>>(
+                "packediksklvl21");
+            packedikskgen<lvl21param>(*packediksklvl21, sk);
+        }
+        else
+            static_assert(false_v<typename P::T>, "Not predefined parameter!");
+    }
+    template <class P>
+    void emplaceiksk2packediksk()
+    {
+        if constexpr (std::is_same_v<P, lvl10param>) {
+            packediksklvl10 = allocatekey<PackedKeySwitchingKey<lvl10param>>(
+                "packediksklvl10");
+            ikskpack<lvl10param>(*packediksklvl10, getiksk<lvl10param>());
+        }
+        else if constexpr (std::is_same_v<P, lvl1hparam>) {
+            packediksklvl1h = allocatekey<PackedKeySwitchingKey<lvl1hparam>>(
+                "packediksklvl1h");
+            ikskpack<lvl1hparam>(*packediksklvl1h, getiksk<lvl1hparam>());
+        }
+        else if constexpr (std::is_same_v<P, lvl20param>) {
+            packediksklvl20 = allocatekey<PackedKeySwitchingKey<lvl20param>>(
+                "packediksklvl20");
+            ikskpack<lvl20param>(*packediksklvl20, getiksk<lvl20param>());
+        }
+        else if constexpr (std::is_same_v<P, lvl21param>) {
+            packediksklvl21 = allocatekey<PackedKeySwitchingKey<lvl21param>>(
+                "packediksklvl21");
+            ikskpack<lvl21param>(*packediksklvl21, getiksk<lvl21param>());
+        }
+        else
+            static_assert(false_v<typename P::T>, "Not predefined parameter!");
+    }
+    template <class P>
+    void emplaceseediksk(const SecretKey& sk)
+    {
+        if constexpr (std::is_same_v<P, lvl10param>) {
+            seediksklvl10 =
+                allocatekey<SeededKeySwitchingKey<lvl10param>>("seediksklvl10");
+            seededikskgen<lvl10param>(*seediksklvl10, sk);
+        }
+        else if constexpr (std::is_same_v<P, lvl1hparam>) {
+            seediksklvl1h =
+                allocatekey<SeededKeySwitchingKey<lvl1hparam>>("seediksklvl1h");
+            seededikskgen<lvl1hparam>(*seediksklvl1h, sk);
+        }
+        else if constexpr (std::is_same_v<P, lvl20param>) {
+            seediksklvl20 =
+                allocatekey<SeededKeySwitchingKey<lvl20param>>("seediksklvl20");
+            seededikskgen<lvl20param>(*seediksklvl20, sk);
+        }
+        else if constexpr (std::is_same_v<P, lvl21param>) {
+            seediksklvl21 =
+                allocatekey<SeededKeySwitchingKey<lvl21param>>("seediksklvl21");
+            seededikskgen<lvl21param>(*seediksklvl21, sk);
+        }
+        else
+            static_assert(false_v<typename P::T>, "Not predefined parameter!");
+    }
+    // Expands the seeded key into the key used by IdentityKeySwitch, e.g.
+    // right after loading it.
+    template <class P>
+    void emplaceseediksk2iksk()
+    {
+        if constexpr (std::is_same_v<P, lvl10param>) {
+            iksklvl10 = allocatekey<KeySwitchingKey<lvl10param>>("iksklvl10");
+            ikskexpand<lvl10param>(*iksklvl10, getseediksk<lvl10param>());
+        }
+        else if constexpr (std::is_same_v<P, lvl1hparam>) {
+            iksklvl1h = allocatekey<KeySwitchingKey<lvl1hparam>>("iksklvl1h");
+            ikskexpand<lvl1hparam>(*iksklvl1h, getseediksk<lvl1hparam>());
+        }
+        else if constexpr (std::is_same_v<P, lvl20param>) {
+            iksklvl20 = allocatekey<KeySwitchingKey<lvl20param>>("iksklvl20");
+            ikskexpand<lvl20param>(*iksklvl20, getseediksk<lvl20param>());
+        }
+        else if constexpr (std::is_same_v<P, lvl21param>) {
+            iksklvl21 = allocatekey<KeySwitchingKey<lvl21param>>("iksklvl21");
+            ikskexpand<lvl21param>(*iksklvl21, getseediksk<lvl21param>());
+        }
+        else
+            static_assert(false_v<typename P::T>, "Not predefined parameter!");
+    }
+    template <class P>
+    void emplaceahk(const SecretKey& sk)
+    {
+        if constexpr (std::is_same_v<P, lvl1param>) {
+            ahklvl1 = allocatekey<AnnihilateKey<lvl1param>>("ahklvl1");
+            annihilatekeygen<lvl1param>(*ahklvl1, sk);
+        }
+        else if constexpr (std::is_same_v<P, lvl2param>) {
+            ahklvl2 = allocatekey<AnnihilateKey<lvl2param>>("ahklvl2");
+            annihilatekeygen<lvl2param>(*ahklvl2, sk);
+        }
+        else
+            static_assert(false_v<typename P::T>, "Not predefined parameter!");
+    }
+    template <class P>
     void emplacesubiksk(const SecretKey& sk)
     {
         if constexpr (std::is_same_v<P, lvl21param>) {
-            subiksklvl21 = std::make_unique<
-                SubsetKeySwitchingKey<lvl21param>>();
+            subiksklvl21 =
+                allocatekey<SubsetKeySwitchingKey<lvl21param>>("subiksklvl21");
             subikskgen<lvl21param>(*subiksklvl21, sk);
         }
         else
@@ -467,21 +1011,18 @@ struct EvalKey {
                         const SecretKey& sk)
     {
         if constexpr (std::is_same_v<P, lvl11param>) {
-            privksklvl11[key] =
-                std::unique_ptr<PrivateKeySwitchingKey<lvl11param>>(new (
-                    std::align_val_t(64)) PrivateKeySwitchingKey<lvl11param>());
+            privksklvl11[key] = allocatekey<PrivateKeySwitchingKey<lvl11param>>(
+                "privksklvl11/" + key);
             privkskgen<lvl11param>(*privksklvl11[key], func, sk);
         }
         else if constexpr (std::is_same_v<P, lvl21param>) {
-            privksklvl21[key] =
-                std::unique_ptr<PrivateKeySwitchingKey<lvl21param>>(new (
-                    std::align_val_t(64)) PrivateKeySwitchingKey<lvl21param>());
+            privksklvl21[key] = allocatekey<PrivateKeySwitchingKey<lvl21param>>(
+                "privksklvl21/" + key);
             privkskgen<lvl21param>(*privksklvl21[key], func, sk);
         }
         else if constexpr (std::is_same_v<P, lvl22param>) {
-            privksklvl22[key] =
-                std::unique_ptr<PrivateKeySwitchingKey<lvl22param>>(new (
-                    std::align_val_t(64)) PrivateKeySwitchingKey<lvl22param>());
+            privksklvl22[key] = allocatekey<PrivateKeySwitchingKey<lvl22param>>(
+                "privksklvl22/" + key);
             privkskgen<lvl22param>(*privksklvl22[key], func, sk);
         }
         else
@@ -494,8 +1035,9 @@ struct EvalKey {
                            const SecretKey& sk)
     {
         if constexpr (std::is_same_v<P, lvl21param>) {
-            subprivksklvl21[key] = std::make_unique<
-                SubsetPrivateKeySwitchingKey<lvl21param>>();
+            subprivksklvl21[key] =
+                allocatekey<SubsetPrivateKeySwitchingKey<lvl21param>>(
+                    "subprivksklvl21/" + key);
             subprivkskgen<lvl21param>(*subprivksklvl21[key], func, sk);
         }
         else
@@ -530,20 +1072,43 @@ struct EvalKey {
     }
 
     // get keys
+    //
+    // Keys of an EvalKey made by mapevalkeyfile or openevalkeyfile in map
+    // mode live in a copy-on-write mapping of the file: writing through the
+    // references returned here copies the pages written and leaves the file
+    // as it is.
     template <class P>
     BootstrappingKey<P>& getbk() const
     {
         if constexpr (std::is_same_v<P, lvl01param>) {
-            return *bklvl01;
+            return getkey("bklvl01", bklvl01);
         }
         else if constexpr (std::is_same_v<P, lvlh1param>) {
-            return *bklvlh1;
+            return getkey("bklvlh1", bklvlh1);
         }
         else if constexpr (std::is_same_v<P, lvl02param>) {
-            return *bklvl02;
+            return getkey("bklvl02", bklvl02);
         }
         else if constexpr (std::is_same_v<P, lvlh2param>) {
-            return *bklvlh2;
+            return getkey("bklvlh2", bklvlh2);
+        }
+        else
+            static_assert(false_v<typename P::T>, "Not predefined parameter!");
+    }
+    template <class P>
+    SeededBootstrappingKey<P>& getseedbk() const
+    {
+        if constexpr (std::is_same_v<P, lvl01param>) {
+            return getkey("seedbklvl01", seedbklvl01);
+        }
+        else if constexpr (std::is_same_v<P, lvlh1param>) {
+            return getkey("seedbklvlh1", seedbklvlh1);
+        }
+        else if constexpr (std::is_same_v<P, lvl02param>) {
+            return getkey("seedbklvl02", seedbklvl02);
+        }
+        else if constexpr (std::is_same_v<P, lvlh2param>) {
+            return getkey("seedbklvlh2", seedbklvlh2);
         }
         else
             static_assert(false_v<typename P::T>, "Not predefined parameter!");
@@ -552,16 +1117,25 @@ struct EvalKey {
     BootstrappingKeyFFT<P>& getbkfft() const
     {
         if constexpr (std::is_same_v<P, lvl01param>) {
-            return *bkfftlvl01;
+            return getkey("bkfftlvl01", bkfftlvl01);
         }
         else if constexpr (std::is_same_v<P, lvlh1param>) {
-            return *bkfftlvlh1;
+            return getkey("bkfftlvlh1", bkfftlvlh1);
         }
         else if constexpr (std::is_same_v<P, lvl02param>) {
-            return *bkfftlvl02;
+            return getkey("bkfftlvl02", bkfftlvl02);
         }
         else if constexpr (std::is_same_v<P, lvlh2param>) {
-            return *bkfftlvlh2;
+            return getkey("bkfftlvlh2", bkfftlvlh2);
+        }
+        else if constexpr (std::is_same_v<P, lvl01Addends2param>) {
+            return getkey("bkfftlvl01addends2", bkfftlvl01addends2);
+        }
+        else if constexpr (std::is_same_v<P, lvl01Addends3param>) {
+            return getkey("bkfftlvl01addends3", bkfftlvl01addends3);
+        }
+        else if constexpr (std::is_same_v<P, lvl02Addends2param>) {
+            return getkey("bkfftlvl02addends2", bkfftlvl02addends2);
         }
         else
             static_assert(false_v<typename P::T>, "Not predefined parameter!");
@@ -571,25 +1145,73 @@ struct EvalKey {
     KeySwitchingKey<P>& getiksk() const
     {
         if constexpr (std::is_same_v<P, lvl10param>) {
-            return *iksklvl10;
+            return getkey("iksklvl10", iksklvl10);
         }
         else if constexpr (std::is_same_v<P, lvl1hparam>) {
-            return *iksklvl1h;
+            return getkey("iksklvl1h", iksklvl1h);
         }
         else if constexpr (std::is_same_v<P, lvl20param>) {
-            return *iksklvl20;
+            return getkey("iksklvl20", iksklvl20);
         }
         // else if constexpr (std::is_same_v<P, lvl2hparam>) {
-        //     return *iksklvl2h;
+        //     return getkey("iksklvl2h", iksklvl2h);
         // }
         else if constexpr (std::is_same_v<P, lvl21param>) {
-            return *iksklvl21;
+            return getkey("iksklvl21", iksklvl21);
         }
         else if constexpr (std::is_same_v<P, lvl22param>) {
-            return *iksklvl22;
+            return getkey("iksklvl22", iksklvl22);
         }
         else if constexpr (std::is_same_v<P, lvl31param>) {
-            return *iksklvl31;
+            return getkey("iksklvl31", iksklvl31);
+        }
+        else
+            static_assert(false_v<typename P::T>, "Not predefined parameter!");
+    }
+    template <class P>
+    PackedKeySwitchingKey<P>& getpackediksk() const
+    {
+        if constexpr (std::is_same_v<P, lvl10param>) {
+            return getkey("packediksklvl10", packediksklvl10);
+        }
+        else if constexpr (std::is_same_v<P, lvl1hparam>) {
+            return getkey("packediksklvl1h", packediksklvl1h);
+        }
+        else if constexpr (std::is_same_v<P, lvl20param>) {
+            return getkey("packediksklvl20", packediksklvl20);
+        }
+        else if constexpr (std::is_same_v<P, lvl21param>) {
+            return getkey("packediksklvl21", packediksklvl21);
+        }
+        else
+            static_assert(false_v<typename P::T>, "Not predefined parameter!");
+    }
+    template <class P>
+    SeededKeySwitchingKey<P>& getseediksk() const
+    {
+        if constexpr (std::is_same_v<P, lvl10param>) {
+            return getkey("seediksklvl10", seediksklvl10);
+        }
+        else if constexpr (std::is_same_v<P, lvl1hparam>) {
+            return getkey("seediksklvl1h", seediksklvl1h);
+        }
+        else if constexpr (std::is_same_v<P, lvl20param>) {
+            return getkey("seediksklvl20", seediksklvl20);
+        }
+        else if constexpr (std::is_same_v<P, lvl21param>) {
+            return getkey("seediksklvl21", seediksklvl21);
+        }
+        else
+            static_assert(false_v<typename P::T>, "Not predefined parameter!");
+    }
+    template <class P>
+    AnnihilateKey<P>& getahk() const
+    {
+        if constexpr (std::is_same_v<P, lvl1param>) {
+            return getkey("ahklvl1", ahklvl1);
+        }
+        else if constexpr (std::is_same_v<P, lvl2param>) {
+            return getkey("ahklvl2", ahklvl2);
         }
         else
             static_assert(false_v<typename P::T>, "Not predefined parameter!");
@@ -598,7 +1220,7 @@ struct EvalKey {
     SubsetKeySwitchingKey<P>& getsubiksk() const
     {
         if constexpr (std::is_same_v<P, lvl21param>) {
-            return *subiksklvl21;
+            return getkey("subiksklvl21", subiksklvl21);
         }
         else
             static_assert(false_v<typename P::T>, "Not predefined parameter!");
@@ -607,13 +1229,13 @@ struct EvalKey {
     PrivateKeySwitchingKey<P>& getprivksk(const std::string& key) const
     {
         if constexpr (std::is_same_v<P, lvl11param>) {
-            return *(privksklvl11.at(key));
+            return getkey("privksklvl11", privksklvl11, key);
         }
         else if constexpr (std::is_same_v<P, lvl21param>) {
-            return *(privksklvl21.at(key));
+            return getkey("privksklvl21", privksklvl21, key);
         }
         else if constexpr (std::is_same_v<P, lvl22param>) {
-            return *(privksklvl22.at(key));
+            return getkey("privksklvl22", privksklvl22, key);
         }
         else
             static_assert(false_v<typename P::T>, "Not predefined parameter!");
@@ -622,12 +1244,92 @@ struct EvalKey {
     SubsetPrivateKeySwitchingKey<P>& getsubprivksk(const std::string& key) const
     {
         if constexpr (std::is_same_v<P, lvl21param>) {
-            return *(subprivksklvl21.at(key));
+            return getkey("subprivksklvl21", subprivksklvl21, key);
         }
         else
             static_assert(false_v<typename P::targetP::T>,
                           "Not predefined parameter!");
     }
+
+private:
+    template <class T>
+    std::shared_ptr<T> allocatekey(const std::string& name)
+    {
+        static_assert(std::is_trivially_destructible_v<T>);
+        KeyAllocation allocation;
+        const std::shared_ptr<void> memory =
+            allocatekeymemory(sizeof(T), allocpolicy, allocation);
+        allocation.name = name;
+        allocations.push_back(allocation);
+        return std::shared_ptr<T>(memory, new (memory.get()) T);
+    }
+
+    template <class T>
+    T& getkey(const char* name, const std::shared_ptr<T>& key) const
+    {
+        if (!key && keyfile)
+            return *static_cast<T*>(
+                evalkeyfileload(*keyfile, name, {}, sizeof(T)));
+        return *key;
+    }
+    template <class T>
+    T& getkey(const char* name,
+              const std::unordered_map<std::string, std::shared_ptr<T>>& keys,
+              const std::string& key) const
+    {
+        const auto it = keys.find(key);
+        if (it == keys.end() && keyfile)
+            return *static_cast<T*>(
+                evalkeyfileload(*keyfile, name, key, sizeof(T)));
+        return *keys.at(key);
+    }
+
+    template <class EK, class F>
+    static void foreachkeyof(EK& ek, F& f)
+    {
+        f("bklvl01", ek.bklvl01);
+        f("bklvlh1", ek.bklvlh1);
+        f("bklvl02", ek.bklvl02);
+        f("bklvlh2", ek.bklvlh2);
+        f("bkfftlvl01", ek.bkfftlvl01);
+        f("bkfftlvlh1", ek.bkfftlvlh1);
+        f("bkfftlvl02", ek.bkfftlvl02);
+        f("bkfftlvlh2", ek.bkfftlvlh2);
+        f("bkfftlvl01addends2", ek.bkfftlvl01addends2);
+        f("bkfftlvl01addends3", ek.bkfftlvl01addends3);
+        f("bkfftlvl02addends2", ek.bkfftlvl02addends2);
+        f("bknttlvl01", ek.bknttlvl01);
+        f("bknttlvlh1", ek.bknttlvlh1);
+        f("bknttlvl02", ek.bknttlvl02);
+        f("bknttlvlh2", ek.bknttlvlh2);
+        f("seedbklvl01", ek.seedbklvl01);
+        f("seedbklvlh1", ek.seedbklvlh1);
+        f("seedbklvl02", ek.seedbklvl02);
+        f("seedbklvlh2", ek.seedbklvlh2);
+        f("iksklvl10", ek.iksklvl10);
+        f("iksklvl1h", ek.iksklvl1h);
+        f("iksklvl20", ek.iksklvl20);
+        f("iksklvl21", ek.iksklvl21);
+        f("iksklvl22", ek.iksklvl22);
+        f("iksklvl31", ek.iksklvl31);
+        f("packediksklvl10", ek.packediksklvl10);
+        f("packediksklvl1h", ek.packediksklvl1h);
+        f("packediksklvl20", ek.packediksklvl20);
+        f("packediksklvl21", ek.packediksklvl21);
+        f("seediksklvl10", ek.seediksklvl10);
+        f("seediksklvl1h", ek.seediksklvl1h);
+        f("seediksklvl20", ek.seediksklvl20);
+        f("seediksklvl21", ek.seediksklvl21);
+        f("ahklvl1", ek.ahklvl1);
+        f("ahklvl2", ek.ahklvl2);
+        f("subiksklvl21", ek.subiksklvl21);
+        f("privksklvl11", ek.privksklvl11);
+        f("privksklvl21", ek.privksklvl21);
+        f("privksklvl22", ek.privksklvl22);
+        f("subprivksklvl21", ek.subprivksklvl21);
+    }
 };
 
-}  // namespace TFHEpp
\ No newline at end of file
+}  // namespace TFHEpp
+
+CEREAL_CLASS_VERSION(TFHEpp::EvalKey, 1);
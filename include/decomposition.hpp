@@ -78,7 +78,8 @@ inline void Decomposition(DecomposedPolynomial<P> &decpoly,
 
 template <class P, int batch>
 inline void Decompositionbatch(DecomposedPolynomialn<P, batch> &decpoly,
-                          const Polynomialn<P, batch> &poly, typename P::T randbits = 0)
+                          const Polynomialn<P, batch> &poly, typename P::T randbits = 0,
+                          const int active = batch)
 {
     constexpr typename P::T offset = offsetgen<P>();
     constexpr uint32_t roundoffsetBit = std::numeric_limits<typename P::T>::digits - P::l * P::Bgbit - 1;
@@ -89,7 +90,7 @@ inline void Decompositionbatch(DecomposedPolynomialn<P, batch> &decpoly,
     constexpr typename P::T halfBg = (1ULL << (P::Bgbit - 1));
     constexpr uint32_t maxDigits = std::numeric_limits<typename P::T>::digits;
 
-    for (int j = 0; j < batch; j++) {
+    for (int j = 0; j < active; j++) {
         for (int i = 0; i < P::n; i++) {
             auto valuePlusOffset = poly[j][i] + totaloffset;
             for (int ii = 0; ii < P::l; ii++) {
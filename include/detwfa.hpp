@@ -70,42 +70,103 @@ void CMUXFFTwithPolynomialMulByXaiMinusOne(
     }
 }
 
+// Unrolled variant for bkP::Addends > 1. a holds the rotation amounts of the
+// Addends coefficients covered by cs. The TRGSWs of cs are combined in the
+// Fourier domain as sum_v (X^{<a,v>} - 1) * BK_v, so only one external
+// product is needed for all of the coefficients.
+template <class bkP>
+void CMUXFFTwithPolynomialMulByXaiMinusOne(
+    TRLWE<typename bkP::targetP> &acc,
+    const BootstrappingKeyElementFFT<bkP> &cs,
+    const std::array<int, bkP::Addends> &a)
+{
+    using P = typename bkP::targetP;
+    constexpr auto patterns = bkpatterngen<bkP>();
+    alignas(64) TRGSWFFT<P> trgswfft;
+    alignas(64) Polynomial<P> xaiminusone;
+    alignas(64) PolynomialInFD<P> xaiminusonefft;
+    bool first = true;
+    for (int count = 0; count < bkelemnum<bkP>(); count++) {
+        int exponent = 0;
+        for (int t = 0; t < bkP::Addends; t++)
+            exponent += a[t] * patterns[count][t];
+        exponent %= static_cast<int>(2 * P::n);
+        if (exponent < 0) exponent += 2 * P::n;
+        if (exponent == 0) continue;
+        xaiminusone = {};
+        xaiminusone[0] = -1;
+        if (exponent < P::n)
+            xaiminusone[exponent] += 1;
+        else
+            xaiminusone[exponent - P::n] -= 1;
+        TwistIFFT<P>(xaiminusonefft, xaiminusone);
+        for (int i = 0; i < (P::k + 1) * P::l; i++)
+            for (int m = 0; m < P::k + 1; m++) {
+                if (first)
+                    MulInFD<P::n>(trgswfft[i][m], xaiminusonefft,
+                                  cs[count][i][m]);
+                else
+                    FMAInFD<P::n>(trgswfft[i][m], xaiminusonefft,
+                                  cs[count][i][m]);
+            }
+        first = false;
+    }
+    if (first) return;
+    alignas(64) TRLWE<P> temp;
+    trgswfftExternalProduct<P>(temp, acc, trgswfft);
+    for (int k = 0; k < P::k + 1; k++)
+        for (int i = 0; i < P::n; i++) acc[k][i] += temp[k][i];
+}
+
+// Only the ciphertexts listed in the first active entries of activeArray take
+// part in the CMUX. They are gathered into the first active slots of temp so
+// that zero rotations cost no transform. temp is scratch space owned by the
+// caller, which reuses it over the CMUXes of a blind rotation.
 template <class bkP, int batch>
 void CMUXFFTwithPolynomialMulByXaiMinusOnebatch(
     TRLWEn<typename bkP::targetP, batch> &acc,
-    const BootstrappingKeyElementFFT<bkP> &cs, const intArray<batch> &aArray)
+    TRLWEn<typename bkP::targetP, batch> &temp,
+    const BootstrappingKeyElementFFT<bkP> &cs, const intArray<batch> &aArray,
+    const intArray<batch> &activeArray, const int active)
 {
     if constexpr (bkP::domainP::key_value_diff == 1) {
-        alignas(64) TRLWEn<typename bkP::targetP, batch> temp;
-        for (int j = 0; j < batch; j++)
+        for (int idx = 0; idx < active; idx++) {
+            const int j = activeArray[idx];
             for (int k = 0; k < bkP::targetP::k + 1; k++)
-                PolynomialMulByXaiMinusOne<typename bkP::targetP>(temp[k][j], acc[k][j],
-                                                                  aArray[j]);
-        trgswfftExternalProductbatch<typename bkP::targetP, batch>(temp, temp, cs[0]);
-        for (int j = 0; j < batch; j++)
+                PolynomialMulByXaiMinusOne<typename bkP::targetP>(
+                    temp[k][idx], acc[k][j], aArray[j]);
+        }
+        trgswfftExternalProductbatch<typename bkP::targetP, batch>(
+            temp, temp, cs[0], active);
+        for (int idx = 0; idx < active; idx++) {
+            const int j = activeArray[idx];
             for (int k = 0; k < bkP::targetP::k + 1; k++)
-                for (int i = 0; i < bkP::targetP::n; i++) acc[k][j][i] += temp[k][j][i];
+                for (int i = 0; i < bkP::targetP::n; i++)
+                    acc[k][j][i] += temp[k][idx][i];
+        }
     }
     else {
-        alignas(32) TRLWEn<typename bkP::targetP, batch> temp;
         int count = 0;
         for (int i = bkP::domainP::key_value_min;
              i <= bkP::domainP::key_value_max; i++) {
             if (i != 0) {
-
-                for (int j = 0; j < batch; j++) {
+                for (int idx = 0; idx < active; idx++) {
+                    const int j = activeArray[idx];
                     const int mod = (aArray[j] * i) % (2 * bkP::targetP::n);
-                    const int index = mod > 0 ? mod : mod + (2 * bkP::targetP::n);
+                    const int index =
+                        mod > 0 ? mod : mod + (2 * bkP::targetP::n);
                     for (int k = 0; k < bkP::targetP::k + 1; k++)
                         PolynomialMulByXaiMinusOne<typename bkP::targetP>(
-                            temp[k][j], acc[k][j], index);
+                            temp[k][idx], acc[k][j], index);
                 }
-                trgswfftExternalProductbatch<typename bkP::targetP, batch>(temp, temp,
-                                                               cs[count]);
-                for (int j = 0; j < batch; j++)
+                trgswfftExternalProductbatch<typename bkP::targetP, batch>(
+                    temp, temp, cs[count], active);
+                for (int idx = 0; idx < active; idx++) {
+                    const int j = activeArray[idx];
                     for (int k = 0; k < bkP::targetP::k + 1; k++)
                         for (int n = 0; n < bkP::targetP::n; n++)
-                            acc[k][j][n] += temp[k][j][n];
+                            acc[k][j][n] += temp[k][idx][n];
+                }
                 count++;
             }
         }
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cloudkey.hpp"
+
+namespace TFHEpp {
+
+// Memory-mappable layout of an EvalKey. The file starts with an
+// EvalKeyFileHeader followed by one EvalKeyFileSection per key, then the keys
+// themselves as raw bytes at 64-byte aligned offsets. mapevalkeyfile uses the
+// keys in place, so loading does not parse or copy them and every process
+// mapping the same file shares the pages it does not write to.
+//
+// The keys are stored in the native byte order and layout of the build that
+// wrote them. The header records enough to reject files of another byte
+// order, format version or parameter set, and every section records the size
+// of its key.
+constexpr std::array<char, 8> evalkeyfilemagic = {'T', 'F', 'H', 'E',
+                                                  'p', 'p', 'E', 'K'};
+constexpr uint32_t evalkeyfileversion = 1;
+constexpr uint32_t evalkeyfilebyteorder = 0x01020304;
+constexpr uint64_t evalkeyfilealign = 64;
+
+struct EvalKeyFileHeader {
+    std::array<char, 8> magic;
+    uint32_t version;
+    uint32_t byteorder;
+    // lweParams::fingerprint() of the parameters of the keys.
+    uint64_t fingerprint;
+    uint64_t sectionnum;
+    uint64_t filesize;
+    std::array<uint64_t, 3> reserved;
+};
+static_assert(sizeof(EvalKeyFileHeader) == evalkeyfilealign);
+
+struct EvalKeyFileSection {
+    // Name of the EvalKey member, followed by '/' and the key for the
+    // members which are maps. NUL terminated.
+    std::array<char, 48> name;
+    uint64_t offset;
+    uint64_t size;
+};
+static_assert(sizeof(EvalKeyFileSection) == evalkeyfilealign);
+
+// Index of an EvalKey file. Only the header and the section table are read on
+// construction; a key is mapped or read when it is first loaded, and can be
+// prefetched ahead of use or evicted when no longer needed. Keys are named as
+// in the file, e.g. "bkfftlvl01" or "privksklvl21/identity".
+//
+// An EvalKey made by openevalkeyfile loads its keys through an EvalKeyFile
+// from its get* functions, so a worker only pays for the keys it uses.
+class EvalKeyFile {
+public:
+    enum class Mode {
+        // Keys point into a copy-on-write mapping of the file.
+        map,
+        // Keys are read into private 64-byte aligned memory.
+        read
+    };
+
+    // Throws std::runtime_error if the file cannot be opened or was not
+    // written for this build's parameters.
+    explicit EvalKeyFile(const std::string& path, Mode mode = Mode::map);
+    ~EvalKeyFile();
+    EvalKeyFile(const EvalKeyFile&) = delete;
+    EvalKeyFile& operator=(const EvalKeyFile&) = delete;
+
+    bool contains(const std::string& name) const;
+    std::vector<std::string> names() const;
+
+    // Returns the key, loading it if needed. Throws std::out_of_range if the
+    // file has no such key and std::runtime_error if its size is not size.
+    std::shared_ptr<void> load(const std::string& name, uint64_t size);
+    // As load, for the key member, or member + "/" + key if key is not empty.
+    // A key loaded before is found without taking the lock or allocating, so
+    // this is what the get* functions of EvalKey call on every use.
+    void* get(std::string_view member, std::string_view key, uint64_t size);
+
+    // Loads the key and asks the kernel to read its pages ahead.
+    void prefetch(const std::string& name);
+    // Releases the memory of the key. References obtained before stay valid
+    // in map mode, as the pages are read again from the file on access, which
+    // also drops any writes to them, but dangle in read mode, so a key must
+    // not be evicted while it is in use there.
+    void evict(const std::string& name);
+    // Total size of the loaded keys.
+    uint64_t loadedbytes() const;
+
+private:
+    struct Component {
+        explicit Component(const EvalKeyFileSection& section)
+            : section(section)
+        {
+        }
+
+        EvalKeyFileSection section;
+        std::shared_ptr<void> data;
+        // data.get() while the key is loaded, read without the lock.
+        std::atomic<void*> loaded{nullptr};
+    };
+
+    struct SectionName {
+        std::string_view member;
+        std::string_view key;
+    };
+    // Compares name with the name of section, like std::string does.
+    static int compare(std::string_view name, const SectionName& section);
+    // Orders the sections by name and finds them by SectionName without
+    // making a std::string.
+    struct NameLess {
+        using is_transparent = void;
+        bool operator()(const std::string& a, const std::string& b) const
+        {
+            return a < b;
+        }
+        bool operator()(const std::string& a, const SectionName& b) const
+        {
+            return compare(a, b) < 0;
+        }
+        bool operator()(const SectionName& a, const std::string& b) const
+        {
+            return compare(b, a) > 0;
+        }
+    };
+
+    void advise(const EvalKeyFileSection& section, int advice) const;
+
+    std::string path;
+    Mode mode;
+    int fd = -1;
+    std::shared_ptr<void> mapping;
+    // Fixed after construction; only the Components change.
+    std::map<std::string, Component, NameLess> components;
+    mutable std::mutex mutex;
+};
+
+// Writes every key held by ek. Throws std::runtime_error on I/O errors.
+void writeevalkeyfile(const std::string& path, const EvalKey& ek);
+
+// Maps the file copy-on-write and returns an EvalKey whose keys point into
+// the mapping. The mapping lives as long as any of these keys. Writes to a key
+// copy the pages they touch into this process and never reach the file. Throws
+// std::runtime_error if the file cannot be mapped or was not written for this
+// build's parameters.
+EvalKey mapevalkeyfile(const std::string& path);
+
+// Returns an EvalKey holding no key, which loads each key from the file on its
+// first get*. ek.keyfile gives access to prefetch and evict.
+EvalKey openevalkeyfile(const std::string& path,
+                        EvalKeyFile::Mode mode = EvalKeyFile::Mode::map);
+
+}  // namespace TFHEpp
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "cloudkey.hpp"
+
+namespace TFHEpp {
+
+// Total size of the keys held by ek, including those an EvalKey made by
+// openevalkeyfile has loaded so far.
+uint64_t evalkeybytes(const EvalKey& ek);
+
+// EvalKeys of many tenants under a memory budget. Keys are loaded on demand
+// through a loader callback, shared as immutable objects between all the
+// threads evaluating for a tenant, and evicted least recently used first when
+// the resident keys exceed the budget.
+//
+// A key is used through a Pin, which keeps it resident for the duration of a
+// batch. Pinned keys are never evicted, so the budget is exceeded while more
+// keys are pinned than fit in it.
+class EvalKeyRegistry {
+public:
+    using Loader =
+        std::function<std::shared_ptr<const EvalKey>(const std::string&)>;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t residentkeys = 0;
+        uint64_t residentbytes = 0;
+        uint64_t pinnedkeys = 0;
+    };
+
+    class Pin {
+    public:
+        Pin(Pin&& pin) noexcept;
+        Pin& operator=(Pin&& pin) noexcept;
+        Pin(const Pin&) = delete;
+        Pin& operator=(const Pin&) = delete;
+        ~Pin();
+
+        const EvalKey& operator*() const { return *ek; }
+        const EvalKey* operator->() const { return ek.get(); }
+        const std::shared_ptr<const EvalKey>& get() const { return ek; }
+
+    private:
+        friend class EvalKeyRegistry;
+        Pin(EvalKeyRegistry* registry, const std::string& tenant,
+            std::shared_ptr<const EvalKey> ek);
+        void release();
+
+        EvalKeyRegistry* registry;
+        std::string tenant;
+        std::shared_ptr<const EvalKey> ek;
+    };
+
+    // loader returns the key of a tenant, e.g. by mapevalkeyfile, or throws.
+    EvalKeyRegistry(Loader loader, uint64_t capacitybytes);
+    EvalKeyRegistry(const EvalKeyRegistry&) = delete;
+    EvalKeyRegistry& operator=(const EvalKeyRegistry&) = delete;
+
+    // Returns the key of tenant, loading it if it is not resident. Concurrent
+    // pins of a tenant being loaded wait for the one load. Exceptions of the
+    // loader are passed on, and a loader returning no key throws
+    // std::runtime_error.
+    Pin pin(const std::string& tenant);
+    // Drops the key of tenant unless it is pinned. Returns whether it did.
+    bool evict(const std::string& tenant);
+    bool resident(const std::string& tenant) const;
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<const EvalKey> ek;
+        uint64_t bytes = 0;
+        uint64_t pins = 0;
+        bool loading = false;
+        std::list<std::string>::iterator lru;
+    };
+
+    void unpin(const std::string& tenant, const EvalKey& ek);
+    // Evicts unpinned keys from the least recently used on until the resident
+    // keys fit. Takes the lock held.
+    void shrink();
+
+    Loader loader;
+    uint64_t capacitybytes;
+    std::unordered_map<std::string, Entry> entries;
+    // Tenants of the loaded keys, the most recently used first.
+    std::list<std::string> lru;
+    Stats counters;
+    mutable std::mutex mutex;
+    std::condition_variable loaded;
+};
+
+}  // namespace TFHEpp
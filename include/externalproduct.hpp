@@ -14,7 +14,6 @@ template <class P>
 void trgswfftExternalProduct(TRLWE<P> &res, const TRLWE<P> &trlwe,
                              const TRGSWFFT<P> &trgswfft)
 {
-    std::cout << "e";
     alignas(64) DecomposedPolynomial<P> decpoly;
     Decomposition<P>(decpoly, trlwe[0]);
     alignas(64) PolynomialInFD<P> decpolyfft;
@@ -74,33 +73,33 @@ void trgswfftExternalProductbatch(TRLWEn<P, batch> &res, const TRLWEn<P, batch>
 
 template <class P, int batch>
 void trgswfftExternalProductbatch(TRLWEn<P, batch> &res, const TRLWEn<P, batch> &trlwe,
-                             const TRGSWFFT<P> &trgswfft)
+                             const TRGSWFFT<P> &trgswfft, const int active = batch)
 {
     alignas(64) std::unique_ptr<DecomposedPolynomialn<P, batch>> decpolyPtr = std::make_unique<DecomposedPolynomialn<P, batch>>();
-    Decompositionbatch<P, batch>((*decpolyPtr), trlwe[0]);
+    Decompositionbatch<P, batch>((*decpolyPtr), trlwe[0], 0, active);
 
     alignas(64) std::unique_ptr<PolynomialInFDn<P, batch>> decpolyfftPtr = std::make_unique<PolynomialInFDn<P, batch>>();
-    TwistIFFTbatch<P, batch>((*decpolyfftPtr), (*decpolyPtr)[0]);
+    TwistIFFTbatch<P, batch>((*decpolyfftPtr), (*decpolyPtr)[0], active);
 
     alignas(64) std::unique_ptr<TRLWEInFDn<P, batch>> restrlwefftPtr = std::make_unique<TRLWEInFDn<P, batch>>();
 
     for (int m = 0; m < P::k + 1; m++)
-        MulInFDbatch<P, batch>((*restrlwefftPtr)[m], (*decpolyfftPtr), trgswfft[0][m]);
+        MulInFDbatch<P, batch>((*restrlwefftPtr)[m], (*decpolyfftPtr), trgswfft[0][m], active);
     for (int i = 1; i < P::l; i++) {
-        TwistIFFTbatch<P, batch>((*decpolyfftPtr), (*decpolyPtr)[i]);
+        TwistIFFTbatch<P, batch>((*decpolyfftPtr), (*decpolyPtr)[i], active);
         for (int m = 0; m < P::k + 1; m++)
-            FMAInFDbatch<P, batch>((*restrlwefftPtr)[m], (*decpolyfftPtr), trgswfft[i][m]);
+            FMAInFDbatch<P, batch>((*restrlwefftPtr)[m], (*decpolyfftPtr), trgswfft[i][m], active);
     }
     for (int k = 1; k < P::k + 1; k++) {
-        Decompositionbatch<P, batch>((*decpolyPtr), trlwe[k]);
+        Decompositionbatch<P, batch>((*decpolyPtr), trlwe[k], 0, active);
         for (int i = 0; i < P::l; i++) {
-            TwistIFFTbatch<P, batch>((*decpolyfftPtr), (*decpolyPtr)[i]);
+            TwistIFFTbatch<P, batch>((*decpolyfftPtr), (*decpolyPtr)[i], active);
             for (int m = 0; m < P::k + 1; m++)
                 FMAInFDbatch<P, batch>((*restrlwefftPtr)[m], (*decpolyfftPtr),
-                              trgswfft[i + k * P::l][m]);
+                              trgswfft[i + k * P::l][m], active);
         }
     }
-    for (int k = 0; k < P::k + 1; k++) TwistFFTbatch<P, batch>(res[k], (*restrlwefftPtr)[k]);
+    for (int k = 0; k < P::k + 1; k++) TwistFFTbatch<P, batch>(res[k], (*restrlwefftPtr)[k], active);
 }
 
 
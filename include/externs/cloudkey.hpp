@@ -5,20 +5,52 @@ namespace TFHEpp{
 #define INST(P) \
     extern template void bkgen<P>(BootstrappingKey<P> & bk, const SecretKey& sk)
 TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
+TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE_ADDENDS(INST)
 #undef INST
 
 #define INST(P)                                               \
     extern template void bkfftgen<P>(BootstrappingKeyFFT<P> & bkfft, \
                               const SecretKey& sk)
 TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
+TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE_ADDENDS(INST)
 #undef INST
 
 
+#define INST(P)                                                     \
+    extern template void seededbkgen<P>(SeededBootstrappingKey<P> & bk, \
+                                 const SecretKey& sk)
+TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
+#undef INST
+
+#define INST(P)                                                      \
+    extern template void bkfftexpand<P>(BootstrappingKeyFFT<P> & bkfft, \
+                                 const SeededBootstrappingKey<P>& seeded)
+TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
+#undef INST
+
 #define INST(P) \
     extern template void ikskgen<P>(KeySwitchingKey<P> & ksk, const SecretKey& sk)
 TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
 #undef INST
 
+#define INST(P)                                                 \
+    extern template void seededikskgen<P>(SeededKeySwitchingKey<P> & ksk, \
+                                   const SecretKey& sk)
+TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
+#undef INST
+
+#define INST(P)                                          \
+    extern template void ikskexpand<P>(KeySwitchingKey<P> & ksk, \
+                                const SeededKeySwitchingKey<P>& seeded)
+TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
+#undef INST
+
+#define INST(P)                                               \
+    extern template void packedikskgen<P>(PackedKeySwitchingKey<P> & ksk, \
+                                   const SecretKey& sk)
+TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
+#undef INST
+
 #define INST(P) \
     extern template void subikskgen<P>(SubsetKeySwitchingKey<P> & ksk, const SecretKey& sk)
 TFHEPP_EXPLICIT_INSTANTIATION_SUBSET_KEY_SWITCH_TO_TLWE(INST)
@@ -44,16 +76,47 @@ TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
 
 #define INST(P) extern template void EvalKey::emplacebkfft<P>(const SecretKey& sk)
 TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
+TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE_ADDENDS(INST)
 #undef INST
 
 #define INST(P) extern template void EvalKey::emplacebk2bkfft<P>()
 TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
 #undef INST
 
+#define INST(P) extern template void EvalKey::emplaceseedbk<P>(const SecretKey& sk)
+TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
+#undef INST
+
+#define INST(P) extern template void EvalKey::emplaceseedbk2bkfft<P>()
+TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
+#undef INST
+
 #define INST(P) extern template void EvalKey::emplaceiksk<P>(const SecretKey& sk)
 TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
 #undef INST
 
+#define INST(P) extern template void EvalKey::emplaceahk<P>(const SecretKey& sk)
+TFHEPP_EXPLICIT_INSTANTIATION_TRLWE(INST)
+#undef INST
+
+#define INST(P) \
+    extern template void EvalKey::emplaceseediksk<P>(const SecretKey& sk)
+TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
+#undef INST
+
+#define INST(P) extern template void EvalKey::emplaceseediksk2iksk<P>()
+TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
+#undef INST
+
+#define INST(P) \
+    extern template void EvalKey::emplacepackediksk<P>(const SecretKey& sk)
+TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
+#undef INST
+
+#define INST(P) extern template void EvalKey::emplaceiksk2packediksk<P>()
+TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
+#undef INST
+
 #define INST(P) extern template void EvalKey::emplacesubiksk<P>(const SecretKey& sk)
 TFHEPP_EXPLICIT_INSTANTIATION_SUBSET_KEY_SWITCH_TO_TLWE(INST)
 #undef INST
@@ -29,6 +29,14 @@ INST(lvl0param);
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                      \
+    extern template void HomNAND<brP, mu, iksP>( \
+        TLWE<typename iksP::targetP> & res,      \
+        const TLWE<typename brP::domainP> &ca,   \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 #define INST(iksP, brP, mu, batch)                                                \
     extern template void HomNANDbatch<iksP, brP, mu, batch>(TLWEn<typename brP::targetP, batch> &res, \
                                         const TLWEn<typename iksP::domainP, batch> &ca, \
@@ -36,6 +44,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_BATCH_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP, batch)                      \
+    extern template void HomNANDbatch<brP, mu, iksP, batch>(     \
+        TLWEn<typename iksP::targetP, batch> & res,     \
+        const TLWEn<typename brP::domainP, batch> &ca,  \
+        const TLWEn<typename brP::domainP, batch> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BATCH_BRIKS(INST)
+#undef INST
+
 #define INST(iksP, brP, mu)                                                \
     extern template void HomNOR<iksP, brP, mu>(TLWE<typename brP::targetP> &res, \
                                         const TLWE<typename iksP::domainP> &ca, \
@@ -43,6 +59,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_BATCH_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                     \
+    extern template void HomNOR<brP, mu, iksP>( \
+        TLWE<typename iksP::targetP> & res,     \
+        const TLWE<typename brP::domainP> &ca,  \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 
 #define INST(iksP, brP, mu)                                                \
     extern template void HomXNOR<iksP, brP, mu>(TLWE<typename brP::targetP> &res, \
@@ -51,6 +75,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                      \
+    extern template void HomXNOR<brP, mu, iksP>( \
+        TLWE<typename iksP::targetP> & res,      \
+        const TLWE<typename brP::domainP> &ca,   \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 
 #define INST(iksP, brP, mu)                                                \
     extern template void HomAND<iksP, brP, mu>(TLWE<typename brP::targetP> &res, \
@@ -59,6 +91,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                     \
+    extern template void HomAND<brP, mu, iksP>( \
+        TLWE<typename iksP::targetP> & res,     \
+        const TLWE<typename brP::domainP> &ca,  \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 
 #define INST(iksP, brP, mu)                                                \
     extern template void HomOR<iksP, brP, mu>(TLWE<typename brP::targetP> &res, \
@@ -67,6 +107,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                    \
+    extern template void HomOR<brP, mu, iksP>( \
+        TLWE<typename iksP::targetP> & res,    \
+        const TLWE<typename brP::domainP> &ca, \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 
 #define INST(iksP, brP, mu)                                                \
     extern template void HomXOR<iksP, brP, mu>(TLWE<typename brP::targetP> &res, \
@@ -75,6 +123,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                     \
+    extern template void HomXOR<brP, mu, iksP>( \
+        TLWE<typename iksP::targetP> & res,     \
+        const TLWE<typename brP::domainP> &ca,  \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 
 #define INST(iksP, brP, mu)                                                \
     extern template void HomANDNY<iksP, brP, mu>(TLWE<typename brP::targetP> &res, \
@@ -83,6 +139,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                       \
+    extern template void HomANDNY<brP, mu, iksP>( \
+        TLWE<typename iksP::targetP> & res,       \
+        const TLWE<typename brP::domainP> &ca,    \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 
 #define INST(iksP, brP, mu)                                                \
     extern template void HomANDYN<iksP, brP, mu>(TLWE<typename brP::targetP> &res, \
@@ -91,6 +155,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                       \
+    extern template void HomANDYN<brP, mu, iksP>( \
+        TLWE<typename iksP::targetP> & res,       \
+        const TLWE<typename brP::domainP> &ca,    \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 
 #define INST(iksP, brP, mu)                                                \
     extern template void HomORNY<iksP, brP, mu>(TLWE<typename brP::targetP> &res, \
@@ -99,6 +171,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                      \
+    extern template void HomORNY<brP, mu, iksP>( \
+        TLWE<typename iksP::targetP> & res,      \
+        const TLWE<typename brP::domainP> &ca,   \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 
 #define INST(iksP, brP, mu)                                                \
     extern template void HomORYN<iksP, brP, mu>(TLWE<typename brP::targetP> &res, \
@@ -107,6 +187,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                      \
+    extern template void HomORYN<brP, mu, iksP>( \
+        TLWE<typename iksP::targetP> & res,      \
+        const TLWE<typename brP::domainP> &ca,   \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 
 #define INST(P)                                                   \
     extern template void HomMUX<P>(TLWE<P> & res, const TLWE<P> &cs,     \
@@ -9,6 +9,48 @@ namespace TFHEpp{
 TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
 #undef INST
 
+#define INST(P)                                                               \
+    extern template void IdentityKeySwitch<P>(TLWE<typename P::targetP> & res,       \
+                                       const TLWE<typename P::domainP> &tlwe, \
+                                       const PackedKeySwitchingKey<P> &ksk)
+TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
+#undef INST
+
+extern template void IdentityKeySwitch<lvl21param>(
+    TLWE<lvl1param> &res, const TLWE<lvl2param> &tlwe,
+    const QuantizedKeySwitchingKey<lvl21param> &ksk);
+
+#define INST(P)                                                               \
+    extern template void IdentityKeySwitch<P>(TLWE<typename P::targetP> & res,       \
+                                       const TLWE<typename P::domainP> &tlwe, \
+                                       const SeededKeySwitchingKey<P> &ksk)
+TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
+#undef INST
+
+#define INST(P)                                                    \
+    extern template void IdentityKeySwitchbatch<P>(                          \
+        TLWE<typename P::targetP> * res,                           \
+        const TLWE<typename P::domainP> *tlwe, const int num,      \
+        const KeySwitchingKey<P> &ksk)
+TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
+#undef INST
+
+#define INST(iksP, brP)                                        \
+    extern template void IdentityKeySwitchModSwitch<iksP, brP>(          \
+        RotationIndices<brP> & idx,                            \
+        const TLWE<typename iksP::domainP> &tlwe,              \
+        const KeySwitchingKey<iksP> &ksk)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE(INST)
+#undef INST
+
+#define INST(P)                                        \
+    extern template void SampleExtractIndexKeySwitch<P>(      \
+        TLWE<typename P::targetP> & res,               \
+        const TRLWE<typename P::domainP> &trlwe,       \
+        const int index, const KeySwitchingKey<P> &ksk)
+TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
+#undef INST
+
 #define INST(P)                                                               \
     extern template void SubsetIdentityKeySwitch<P>(TLWE<typename P::targetP> & res,       \
                                        const TLWE<typename P::domainP> &tlwe, \
@@ -35,6 +77,13 @@ TFHEPP_EXPLICIT_INSTANTIATION_TRLWE(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_TRLWE(INST)
 #undef INST
 
+#define INST(P)                                                        \
+    extern template void AnnihilateKeySwitchingbatch<P>(               \
+        TRLWE<P> * res, const TRLWE<P> *trlwe, const int num,          \
+        const AnnihilateKey<P> &ahk)
+TFHEPP_EXPLICIT_INSTANTIATION_TRLWE(INST)
+#undef INST
+
 #define INST(P)                                                           \
     extern template void PrivKeySwitch<P>(TRLWE<typename P::targetP> & res,      \
                                    const TLWE<typename P::domainP> &tlwe, \
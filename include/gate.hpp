@@ -18,6 +18,21 @@ inline void HomGate(TLWE<typename brP::targetP> &res,
     GateBootstrapping<iksP, brP, mu>(res, res, ek);
 }
 
+// lvl0 in, lvl0 out: the linear combination is taken at lvl0 and the
+// bootstrapping ends with the key switch.
+template <class brP, typename brP::targetP::T mu, class iksP, int casign,
+          int cbsign, std::make_signed_t<typename brP::domainP::T> offset>
+inline void HomGate(TLWE<typename iksP::targetP> &res,
+                    const TLWE<typename brP::domainP> &ca,
+                    const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+{
+    alignas(64) TLWE<typename brP::domainP> temp;
+    for (int i = 0; i <= brP::domainP::k * brP::domainP::n; i++)
+        temp[i] = casign * ca[i] + cbsign * cb[i];
+    temp[brP::domainP::k * brP::domainP::n] += offset;
+    GateBootstrapping<brP, mu, iksP>(res, temp, ek);
+}
+
 template <class iksP, class brP, typename brP::targetP::T mu, int casign,
           int cbsign, std::make_signed_t<typename iksP::domainP::T> offset, int batch>
 inline void HomGatebatch(TLWEn<typename brP::targetP, batch> &res,
@@ -34,6 +49,23 @@ inline void HomGatebatch(TLWEn<typename brP::targetP, batch> &res,
     GateBootstrappingbatch<iksP, brP, mu, batch>(res, res, ek);
 }
 
+template <class brP, typename brP::targetP::T mu, class iksP, int casign,
+          int cbsign, std::make_signed_t<typename brP::domainP::T> offset,
+          int batch>
+inline void HomGatebatch(TLWEn<typename iksP::targetP, batch> &res,
+                         const TLWEn<typename brP::domainP, batch> &ca,
+                         const TLWEn<typename brP::domainP, batch> &cb,
+                         const EvalKey &ek)
+{
+    for (int j = 0; j < batch; j++)
+        for (int i = 0; i <= brP::domainP::k * brP::domainP::n; i++)
+            res[j][i] = casign * ca[j][i] + cbsign * cb[j][i];
+
+    for (int j = 0; j < batch; j++)
+        res[j][brP::domainP::k * brP::domainP::n] += offset;
+
+    GateBootstrappingbatch<brP, mu, iksP, batch>(res, res, ek);
+}
 
 // No input
 template <class P = lvl1param>
@@ -72,6 +104,14 @@ void HomNAND(TLWE<typename brP::targetP> &res,
     HomGate<iksP, brP, mu, -1, -1, iksP::domainP::mu>(res, ca, cb, ek);
 }
 
+template <class brP, typename brP::targetP::T mu, class iksP>
+void HomNAND(TLWE<typename iksP::targetP> &res,
+             const TLWE<typename brP::domainP> &ca,
+             const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+{
+    HomGate<brP, mu, iksP, -1, -1, brP::domainP::mu>(res, ca, cb, ek);
+}
+
 
 template <class iksP = lvl10param, class brP = lvl01param,
           typename brP::targetP::T mu = lvl1param::mu, int batch = otherparam::batch>
@@ -82,6 +122,17 @@ void HomNANDbatch(TLWEn<typename brP::targetP, batch> &res,
     HomGatebatch<iksP, brP, mu, -1, -1, iksP::domainP::mu, batch>(res, ca, cb, ek);
 }
 
+// lvl0 in, lvl0 out: the outputs can be fed to the next batch gate as is.
+template <class brP, typename brP::targetP::T mu, class iksP, int batch>
+void HomNANDbatch(TLWEn<typename iksP::targetP, batch> &res,
+                  const TLWEn<typename brP::domainP, batch> &ca,
+                  const TLWEn<typename brP::domainP, batch> &cb,
+                  const EvalKey &ek)
+{
+    HomGatebatch<brP, mu, iksP, -1, -1, brP::domainP::mu, batch>(res, ca, cb,
+                                                                 ek);
+}
+
 
 template <class iksP = lvl10param, class brP = lvl01param,
           typename brP::targetP::T mu = lvl1param::mu>
@@ -92,6 +143,14 @@ void HomNOR(TLWE<typename brP::targetP> &res,
     HomGate<iksP, brP, mu, -1, -1, -iksP::domainP::mu>(res, ca, cb, ek);
 }
 
+template <class brP, typename brP::targetP::T mu, class iksP>
+void HomNOR(TLWE<typename iksP::targetP> &res,
+            const TLWE<typename brP::domainP> &ca,
+            const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+{
+    HomGate<brP, mu, iksP, -1, -1, -brP::domainP::mu>(res, ca, cb, ek);
+}
+
 
 
 template <class iksP = lvl10param, class brP = lvl01param,
@@ -103,6 +162,14 @@ void HomXNOR(TLWE<typename brP::targetP> &res,
     HomGate<iksP, brP, mu, -2, -2, -2 * iksP::domainP::mu>(res, ca, cb, ek);
 }
 
+template <class brP, typename brP::targetP::T mu, class iksP>
+void HomXNOR(TLWE<typename iksP::targetP> &res,
+             const TLWE<typename brP::domainP> &ca,
+             const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+{
+    HomGate<brP, mu, iksP, -2, -2, -2 * brP::domainP::mu>(res, ca, cb, ek);
+}
+
 
 template <class iksP = lvl10param, class brP = lvl01param,
           typename brP::targetP::T mu = lvl1param::mu>
@@ -113,6 +180,14 @@ void HomAND(TLWE<typename brP::targetP> &res,
     HomGate<iksP, brP, mu, 1, 1, -iksP::domainP::mu>(res, ca, cb, ek);
 }
 
+template <class brP, typename brP::targetP::T mu, class iksP>
+void HomAND(TLWE<typename iksP::targetP> &res,
+            const TLWE<typename brP::domainP> &ca,
+            const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+{
+    HomGate<brP, mu, iksP, 1, 1, -brP::domainP::mu>(res, ca, cb, ek);
+}
+
 
 template <class iksP = lvl10param, class brP = lvl01param,
           typename brP::targetP::T mu = lvl1param::mu>
@@ -123,6 +198,14 @@ void HomOR(TLWE<typename brP::targetP> &res,
     HomGate<iksP, brP, mu, 1, 1, iksP::domainP::mu>(res, ca, cb, ek);
 }
 
+template <class brP, typename brP::targetP::T mu, class iksP>
+void HomOR(TLWE<typename iksP::targetP> &res,
+           const TLWE<typename brP::domainP> &ca,
+           const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+{
+    HomGate<brP, mu, iksP, 1, 1, brP::domainP::mu>(res, ca, cb, ek);
+}
+
 
 template <class iksP = lvl10param, class brP = lvl01param,
           typename brP::targetP::T mu = lvl1param::mu>
@@ -133,6 +216,14 @@ void HomXOR(TLWE<typename brP::targetP> &res,
     HomGate<iksP, brP, mu, 2, 2, 2 * iksP::domainP::mu>(res, ca, cb, ek);
 }
 
+template <class brP, typename brP::targetP::T mu, class iksP>
+void HomXOR(TLWE<typename iksP::targetP> &res,
+            const TLWE<typename brP::domainP> &ca,
+            const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+{
+    HomGate<brP, mu, iksP, 2, 2, 2 * brP::domainP::mu>(res, ca, cb, ek);
+}
+
 
 template <class iksP = lvl10param, class brP = lvl01param,
           typename brP::targetP::T mu = lvl1param::mu>
@@ -143,6 +234,14 @@ void HomANDNY(TLWE<typename brP::targetP> &res,
     HomGate<iksP, brP, mu, -1, 1, -iksP::domainP::mu>(res, ca, cb, ek);
 }
 
+template <class brP, typename brP::targetP::T mu, class iksP>
+void HomANDNY(TLWE<typename iksP::targetP> &res,
+              const TLWE<typename brP::domainP> &ca,
+              const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+{
+    HomGate<brP, mu, iksP, -1, 1, -brP::domainP::mu>(res, ca, cb, ek);
+}
+
 
 template <class iksP = lvl10param, class brP = lvl01param,
           typename brP::targetP::T mu = lvl1param::mu>
@@ -153,6 +252,14 @@ void HomANDYN(TLWE<typename brP::targetP> &res,
     HomGate<iksP, brP, mu, 1, -1, -iksP::domainP::mu>(res, ca, cb, ek);
 }
 
+template <class brP, typename brP::targetP::T mu, class iksP>
+void HomANDYN(TLWE<typename iksP::targetP> &res,
+              const TLWE<typename brP::domainP> &ca,
+              const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+{
+    HomGate<brP, mu, iksP, 1, -1, -brP::domainP::mu>(res, ca, cb, ek);
+}
+
 template <class iksP = lvl10param, class brP = lvl01param,
           typename brP::targetP::T mu = lvl1param::mu>
 void HomORNY(TLWE<typename brP::targetP> &res,
@@ -162,6 +269,14 @@ void HomORNY(TLWE<typename brP::targetP> &res,
     HomGate<iksP, brP, mu, -1, 1, iksP::domainP::mu>(res, ca, cb, ek);
 }
 
+template <class brP, typename brP::targetP::T mu, class iksP>
+void HomORNY(TLWE<typename iksP::targetP> &res,
+             const TLWE<typename brP::domainP> &ca,
+             const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+{
+    HomGate<brP, mu, iksP, -1, 1, brP::domainP::mu>(res, ca, cb, ek);
+}
+
 
 template <class iksP = lvl10param, class brP = lvl01param,
           typename brP::targetP::T mu = lvl1param::mu>
@@ -172,6 +287,14 @@ void HomORYN(TLWE<typename brP::targetP> &res,
     HomGate<iksP, brP, mu, 1, -1, iksP::domainP::mu>(res, ca, cb, ek);
 }
 
+template <class brP, typename brP::targetP::T mu, class iksP>
+void HomORYN(TLWE<typename iksP::targetP> &res,
+             const TLWE<typename brP::domainP> &ca,
+             const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+{
+    HomGate<brP, mu, iksP, 1, -1, brP::domainP::mu>(res, ca, cb, ek);
+}
+
 
 // 3input
 // cs?c1:c0
@@ -2,6 +2,7 @@
 
 #include <cmath>
 #include <limits>
+#include <type_traits>
 
 #include "cloudkey.hpp"
 #include "detwfa.hpp"
@@ -44,15 +45,162 @@ constexpr Polynomial<P> mupolygen()
     return poly;
 }
 
+// Scaling factor of the programmable bootstrapping encoding. A message m in
+// [0, plain_modulus) is encoded as m * lutdelta with one bit of padding, so
+// its phase stays in [0, 1/2) and the negacyclic wrap is never hit.
+template <class P, uint32_t plain_modulus = P::plain_modulus>
+constexpr typename P::T lutdelta()
+{
+    return (1ULL << (std::numeric_limits<typename P::T>::digits - 1)) /
+           plain_modulus;
+}
+
+// Test vector evaluating lut with a programmable bootstrapping. Both input
+// and output use the lutdelta encoding. Each message owns a box of
+// N / plain_modulus coefficients centered on its rotation, and the upper
+// half box of message 0 sits negated at the end of the polynomial.
+template <class P, uint32_t plain_modulus = P::plain_modulus>
+Polynomial<P> lutpolygen(const std::array<typename P::T, plain_modulus> &lut)
+{
+    constexpr typename P::T delta = lutdelta<P, plain_modulus>();
+    Polynomial<P> poly;
+    for (uint64_t j = 0; j < P::n; j++) {
+        const uint64_t m = (2 * j * plain_modulus + P::n) / (2 * P::n);
+        poly[j] = m == plain_modulus
+                      ? -static_cast<typename P::T>(lut[0] % plain_modulus) *
+                            delta
+                      : static_cast<typename P::T>(lut[m] % plain_modulus) *
+                            delta;
+    }
+    return poly;
+}
+
+// Evaluates the function encoded in testvector (see lutpolygen) on tlwe.
+// The test vector is built once by the caller and reused across calls; a
+// LookupTable holds one.
+template <class iksP, class bkP>
+void ProgrammableBootstrapping(TLWE<typename bkP::targetP> &res,
+                               const TLWE<typename iksP::domainP> &tlwe,
+                               const Polynomial<typename bkP::targetP> &testvector,
+                               const EvalKey &ek)
+{
+    alignas(64) RotationIndices<bkP> idx;
+    IdentityKeySwitchModSwitch<iksP, bkP>(idx, tlwe, ek.getiksk<iksP>());
+    alignas(64) TRLWE<typename bkP::targetP> acc;
+    BlindRotate<bkP>(acc, idx, ek.getbkfft<bkP>(), testvector);
+    SampleExtractIndex<typename bkP::targetP>(res, acc, 0);
+}
+
+// A function on [0, plain_modulus) with its test vector, which is built once
+// when the table is made and reused by every ProgrammableBootstrapping of it.
+template <class P, uint32_t plain_modulus = P::plain_modulus>
+struct LookupTable {
+    explicit LookupTable(const std::array<typename P::T, plain_modulus> &table)
+        : table(table), testvector(lutpolygen<P, plain_modulus>(table))
+    {
+    }
+    // Tabulates func(m) for every message m.
+    template <class Func,
+              class = std::enable_if_t<
+                  std::is_invocable_r_v<typename P::T, Func, typename P::T>>>
+    explicit LookupTable(Func &&func) : LookupTable(tabulate(func))
+    {
+    }
+
+    std::array<typename P::T, plain_modulus> table;
+    Polynomial<P> testvector;
+
+private:
+    template <class Func>
+    static std::array<typename P::T, plain_modulus> tabulate(Func &func)
+    {
+        std::array<typename P::T, plain_modulus> table;
+        for (uint32_t m = 0; m < plain_modulus; m++) table[m] = func(m);
+        return table;
+    }
+};
+
+template <class iksP, class bkP, uint32_t plain_modulus>
+void ProgrammableBootstrapping(
+    TLWE<typename bkP::targetP> &res, const TLWE<typename iksP::domainP> &tlwe,
+    const LookupTable<typename bkP::targetP, plain_modulus> &lut,
+    const EvalKey &ek)
+{
+    ProgrammableBootstrapping<iksP, bkP>(res, tlwe, lut.testvector, ek);
+}
+
+// Test vector evaluating num_out lookup tables with one blind rotation.
+// BlindRotate<bkP, num_out> rounds the rotation to a multiple of
+// 2^bitwidth, so the table of the i-th function is interleaved at the
+// coefficients congruent to i modulo 2^bitwidth. The rounding costs
+// bitwidth bits of rotation precision and therefore noise margin.
+template <class P, uint32_t plain_modulus, uint32_t num_out>
+Polynomial<P> lutpolygen(
+    const std::array<std::array<typename P::T, plain_modulus>, num_out> &luts)
+{
+    constexpr uint32_t bitwidth = bits_needed<num_out - 1>();
+    static_assert(P::n / plain_modulus >= (1U << bitwidth),
+                  "Too many outputs for the plaintext modulus!");
+    constexpr typename P::T delta = lutdelta<P, plain_modulus>();
+    Polynomial<P> poly = {};
+    for (uint64_t j = 0; j < P::n; j++) {
+        const uint32_t i = j & ((1U << bitwidth) - 1);
+        if (i >= num_out) continue;
+        const uint64_t block = j - i;
+        const uint64_t m = (2 * block * plain_modulus + P::n) / (2 * P::n);
+        poly[j] =
+            m == plain_modulus
+                ? -static_cast<typename P::T>(luts[i][0] % plain_modulus) *
+                      delta
+                : static_cast<typename P::T>(luts[i][m] % plain_modulus) *
+                      delta;
+    }
+    return poly;
+}
+
+// Multi-value programmable bootstrapping: res[i] encrypts the i-th function
+// of the test vector built by the multi-table lutpolygen, sharing one blind
+// rotation.
+template <class iksP, class bkP, uint32_t num_out>
+void ProgrammableBootstrapping(
+    std::array<TLWE<typename bkP::targetP>, num_out> &res,
+    const TLWE<typename iksP::domainP> &tlwe,
+    const Polynomial<typename bkP::targetP> &testvector, const EvalKey &ek)
+{
+    alignas(64) RotationIndices<bkP> idx;
+    IdentityKeySwitchModSwitch<iksP, bkP, num_out>(idx, tlwe,
+                                                   ek.getiksk<iksP>());
+    alignas(64) TRLWE<typename bkP::targetP> acc;
+    BlindRotate<bkP, num_out>(acc, idx, ek.getbkfft<bkP>(), testvector);
+    for (uint32_t i = 0; i < num_out; i++)
+        SampleExtractIndex<typename bkP::targetP>(res[i], acc, i);
+}
+
 template <class iksP, class bkP, typename bkP::targetP::T mu>
 void GateBootstrapping(TLWE<typename iksP::domainP> &res,
                        const TLWE<typename iksP::domainP> &tlwe,
                        const EvalKey &ek)
 {
-    alignas(64) TLWE<typename iksP::targetP> tlwelvl0;
-    IdentityKeySwitch<iksP>(tlwelvl0, tlwe, ek.getiksk<iksP>());
-    GateBootstrappingTLWE2TLWEFFT<bkP>(res, tlwelvl0, ek.getbkfft<bkP>(),
-                                       mupolygen<typename bkP::targetP, mu>());
+    alignas(64) RotationIndices<bkP> idx;
+    IdentityKeySwitchModSwitch<iksP, bkP>(idx, tlwe, ek.getiksk<iksP>());
+    alignas(64) TRLWE<typename bkP::targetP> acc;
+    BlindRotate<bkP>(acc, idx, ek.getbkfft<bkP>(),
+                     mupolygen<typename bkP::targetP, mu>());
+    SampleExtractIndex<typename bkP::targetP>(res, acc, 0);
+}
+
+// Blind rotation first, then the sample extraction fused with the key switch.
+// Input and output are lvl0 ciphertexts, so the lvl1 TLWE is never
+// materialized and gates can be chained at lvl0.
+template <class brP, typename brP::targetP::T mu, class iksP>
+void GateBootstrapping(TLWE<typename iksP::targetP> &res,
+                       const TLWE<typename brP::domainP> &tlwe,
+                       const EvalKey &ek)
+{
+    alignas(64) TRLWE<typename brP::targetP> acc;
+    BlindRotate<brP>(acc, tlwe, ek.getbkfft<brP>(),
+                     mupolygen<typename brP::targetP, mu>());
+    SampleExtractIndexKeySwitch<iksP>(res, acc, 0, ek.getiksk<iksP>());
 }
 
 
@@ -63,12 +211,28 @@ void GateBootstrappingbatch(TLWEn<typename iksP::domainP, batch> &res,
 {
     alignas(64) std::unique_ptr<TLWEn<typename iksP::targetP, batch>> tlwelvl0Ptr = std::make_unique<TLWEn<typename iksP::targetP, batch>>();
 
-    for (int j = 0; j < batch; j++)
-        IdentityKeySwitch<iksP>((*tlwelvl0Ptr)[j], tlwe[j], ek.getiksk<iksP>());
+    IdentityKeySwitchbatch<iksP, batch>(*tlwelvl0Ptr, tlwe,
+                                        ek.getiksk<iksP>());
 
     GateBootstrappingTLWE2TLWEFFTbatch<bkP, batch>(res, *tlwelvl0Ptr, ek.getbkfft<bkP>(),
                                        mupolygen<typename bkP::targetP, mu>());
 }
 
+// Blind rotation first, then the sample extraction fused with the key switch,
+// so lvl0 ciphertexts come out without materializing the lvl1 TLWEs and can
+// be fed to the next gate directly.
+template <class brP, typename brP::targetP::T mu, class iksP, int batch>
+void GateBootstrappingbatch(TLWEn<typename iksP::targetP, batch> &res,
+                            const TLWEn<typename brP::domainP, batch> &tlwe,
+                            const EvalKey &ek)
+{
+    std::unique_ptr<TRLWEn<typename brP::targetP, batch>> accPtr =
+        std::make_unique<TRLWEn<typename brP::targetP, batch>>();
+    BlindRotatebatch<brP, batch>(*accPtr, tlwe, ek.getbkfft<brP>(),
+                                 mupolygen<typename brP::targetP, mu>());
+    SampleExtractIndexKeySwitchbatch<iksP, batch>(res, *accPtr, 0,
+                                                  ek.getiksk<iksP>());
+}
+
 
 }  // namespace TFHEpp
\ No newline at end of file
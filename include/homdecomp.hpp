@@ -53,7 +53,7 @@ void HomDecomp(std::array<TLWE<typename high2midP::targetP>, numdigit> &cres,
 
     // cres will be used as a reusable buffer
     constexpr uint32_t plain_modulusbit = basebit * numdigit;
-#pragma omp parallel for default(none) shared(cin, cres, kskh2m)
+    TFHEPP_OMP(parallel for default(none) shared(cin, cres, kskh2m))
     for (int digit = 1; digit <= numdigit; digit++) {
         TFHEpp::TLWE<typename high2midP::domainP> switchedtlwe;
         for (int i = 0; i <= high2midP::domainP::k * high2midP::domainP::n; i++)
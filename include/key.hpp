@@ -6,6 +6,8 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
+#include <stdexcept>
 #include <cereal/archives/portable_binary.hpp>
 #include <cereal/types/array.hpp>
 
@@ -26,14 +28,78 @@ struct lweKey {
     Key<P> get() const;
 };
 
+template <class P>
+void packkey(PackedKey<P> &packed, const Key<P> &key)
+{
+    static_assert(P::key_value_min >= -1 && P::key_value_max <= 1,
+                  "Only binary and ternary keys can be packed!");
+    packed = {};
+    for (int i = 0; i < P::k * P::n; i++) {
+        const auto s =
+            static_cast<std::make_signed_t<typename P::T>>(key[i]);
+        packed.mag[i / 64] |= static_cast<uint64_t>(s != 0) << (i % 64);
+        if constexpr (P::key_value_min < 0)
+            packed.sign[i / 64] |= static_cast<uint64_t>(s < 0) << (i % 64);
+    }
+}
+
+template <class P>
+PackedKey<P> packkey(const Key<P> &key)
+{
+    PackedKey<P> packed;
+    packkey<P>(packed, key);
+    return packed;
+}
+
+template <class P>
+void unpackkey(Key<P> &key, const PackedKey<P> &packed)
+{
+    for (int i = 0; i < P::k * P::n; i++) {
+        const typename P::T mag = (packed.mag[i / 64] >> (i % 64)) & 1;
+        if constexpr (P::key_value_min < 0)
+            key[i] = (packed.sign[i / 64] >> (i % 64)) & 1 ? -mag : mag;
+        else
+            key[i] = mag;
+    }
+}
+
 struct SecretKey {
     lweKey key;
     lweParams params;
 
+    // Version 1 stores the keys packed, see PackedKey. Archives of earlier
+    // builds stored the Key arrays unpacked with no class version and cannot
+    // be read: their first word is a key coefficient, 0 or 1, which cannot be
+    // told from a version word, so they either throw or load a wrong key.
+    // Such keys have to be regenerated.
     template <class Archive>
-    void serialize(Archive &archive)
+    void save(Archive &archive,
+              [[maybe_unused]] const std::uint32_t version) const
     {
-        archive(key.lvl0, key.lvlhalf, key.lvl1, key.lvl2, key.lvl3, params);
+        archive(packkey<lvl0param>(key.lvl0),
+                packkey<lvlhalfparam>(key.lvlhalf),
+                packkey<lvl1param>(key.lvl1), packkey<lvl2param>(key.lvl2),
+                packkey<lvl3param>(key.lvl3), params);
+    }
+    template <class Archive>
+    void load(Archive &archive, const std::uint32_t version)
+    {
+        if (version != 1)
+            throw std::runtime_error(
+                "SecretKey archive of an unsupported version");
+        PackedKey<lvl0param> lvl0;
+        PackedKey<lvlhalfparam> lvlhalf;
+        PackedKey<lvl1param> lvl1;
+        PackedKey<lvl2param> lvl2;
+        PackedKey<lvl3param> lvl3;
+        archive(lvl0, lvlhalf, lvl1, lvl2, lvl3, params);
+        unpackkey<lvl0param>(key.lvl0, lvl0);
+        unpackkey<lvlhalfparam>(key.lvlhalf, lvlhalf);
+        unpackkey<lvl1param>(key.lvl1, lvl1);
+        unpackkey<lvl2param>(key.lvl2, lvl2);
+        unpackkey<lvl3param>(key.lvl3, lvl3);
     }
 };
 }  // namespace TFHEpp
+
+CEREAL_CLASS_VERSION(TFHEpp::SecretKey, 1);
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace TFHEpp {
+
+// Pages backing an EvalKey component. Bootstrapping and key switching walk
+// keys of tens to hundreds of MB sequentially, so huge pages save most of
+// their TLB misses.
+enum class KeyPages {
+    // 64-byte aligned heap memory.
+    normal,
+    // Anonymous memory aligned to 2 MB and madvised MADV_HUGEPAGE, so the
+    // kernel backs it with transparent huge pages when it can.
+    transparent,
+    // Explicit huge pages from the hugetlb pool (vm.nr_hugepages).
+    hugetlb2m,
+    hugetlb1g,
+};
+
+const char* keypagesname(KeyPages pages);
+
+// How EvalKey allocates its components. Requests which cannot be satisfied
+// fall back to the next smaller kind of page: hugetlb1g, hugetlb2m,
+// transparent, normal.
+struct KeyAllocPolicy {
+    KeyPages pages = KeyPages::normal;
+    // NUMA node the pages are bound to with mbind, or -1 for the default
+    // first-touch placement.
+    int numanode = -1;
+};
+
+// What one component was asked for and what it got.
+struct KeyAllocation {
+    std::string name;
+    uint64_t bytes;
+    KeyPages requested;
+    KeyPages granted;
+    int numanode;
+    bool numabound;
+};
+
+std::ostream& operator<<(std::ostream& os, const KeyAllocation& allocation);
+
+// Reads a policy from the command line arguments argv[first] (a keypagesname)
+// and argv[first + 1] (a NUMA node), either of which may be absent, e.g.
+// "nand 100 hugetlb2m 0" with first = 2. Throws std::invalid_argument on an
+// unknown page name.
+KeyAllocPolicy keyallocpolicy(int argc, const char* const argv[], int first);
+
+// Returns zeroed memory of at least bytes bytes, 64-byte aligned, under
+// policy, and fills allocation but its name.
+std::shared_ptr<void> allocatekeymemory(uint64_t bytes,
+                                        const KeyAllocPolicy& policy,
+                                        KeyAllocation& allocation);
+
+}  // namespace TFHEpp
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "cloudkey.hpp"
+#include "evalkeyfile.hpp"
+
+namespace TFHEpp {
+
+// Generates keys straight into an EvalKey file, a block of rows at a time,
+// instead of building the whole EvalKey in memory first. Only one block is
+// held in memory, and a job which crashed or was stopped resumes from the last
+// block written.
+//
+// The rows done so far are recorded in path + ".progress", which is updated
+// only once the rows it covers are on disk. The header of the key file is
+// written last, so mapevalkeyfile rejects the file until the job has finished,
+// and the progress file is then removed. A resumed job draws fresh noise seeds
+// for the rows it has still to generate.
+//
+//     KeyGenJob job(path, sk);
+//     job.addbkfft<lvl02param>();
+//     job.addiksk<lvl21param>();
+//     job.addprivksk4cb<lvl21param>();
+//     job.run(callback);
+//     EvalKey ek = mapevalkeyfile(path);
+class KeyGenJob {
+public:
+    struct Progress {
+        // Section of the key file being generated, e.g. "bkfftlvl02".
+        std::string component;
+        uint64_t componentrowsdone;
+        uint64_t componentrows;
+        // Over all the keys of the job.
+        uint64_t rowsdone;
+        uint64_t rows;
+        // Rows generated per second since run was called.
+        double rowspersec;
+    };
+    // Called after each block is written. It may throw to stop the job, which
+    // then resumes after that block.
+    using Callback = std::function<void(const Progress&)>;
+
+    KeyGenJob(const std::string& path, const SecretKey& sk);
+    KeyGenJob(const KeyGenJob&) = delete;
+    KeyGenJob& operator=(const KeyGenJob&) = delete;
+
+    template <class P>
+    void addbkfft()
+    {
+        std::string name;
+        if constexpr (std::is_same_v<P, lvl01param>)
+            name = "bkfftlvl01";
+        else if constexpr (std::is_same_v<P, lvlh1param>)
+            name = "bkfftlvlh1";
+        else if constexpr (std::is_same_v<P, lvl02param>)
+            name = "bkfftlvl02";
+        else if constexpr (std::is_same_v<P, lvlh2param>)
+            name = "bkfftlvlh2";
+        else if constexpr (std::is_same_v<P, lvl01Addends2param>)
+            name = "bkfftlvl01addends2";
+        else if constexpr (std::is_same_v<P, lvl01Addends3param>)
+            name = "bkfftlvl01addends3";
+        else if constexpr (std::is_same_v<P, lvl02Addends2param>)
+            name = "bkfftlvl02addends2";
+        else
+            static_assert(false_v<typename P::T>, "Not predefined parameter!");
+        add<BootstrappingKeyFFT<P>>(
+            name, 0, [this](void* row, const uint64_t i, const Seed& seed) {
+                bkfftgenrow<P>(
+                    *static_cast<BootstrappingKeyElementFFT<P>*>(row),
+                    sk.key.get<typename P::domainP>(),
+                    sk.key.get<typename P::targetP>(), seed, i);
+            });
+    }
+
+    template <class P>
+    void addiksk()
+    {
+        std::string name;
+        if constexpr (std::is_same_v<P, lvl10param>)
+            name = "iksklvl10";
+        else if constexpr (std::is_same_v<P, lvl1hparam>)
+            name = "iksklvl1h";
+        else if constexpr (std::is_same_v<P, lvl20param>)
+            name = "iksklvl20";
+        else if constexpr (std::is_same_v<P, lvl21param>)
+            name = "iksklvl21";
+        else if constexpr (std::is_same_v<P, lvl22param>)
+            name = "iksklvl22";
+        else if constexpr (std::is_same_v<P, lvl31param>)
+            name = "iksklvl31";
+        else
+            static_assert(false_v<typename P::T>, "Not predefined parameter!");
+        add<KeySwitchingKey<P>>(
+            name, 0, [this](void* row, const uint64_t i, const Seed& seed) {
+                ikskgenrow<P>(
+                    *static_cast<typename KeySwitchingKey<P>::value_type*>(row),
+                    sk.key.get<typename P::domainP>(),
+                    sk.key.get<typename P::targetP>(), seed, i);
+            });
+    }
+
+    template <class P>
+    void addprivksk(const std::string& key,
+                    const Polynomial<typename P::targetP>& func)
+    {
+        std::string name;
+        if constexpr (std::is_same_v<P, lvl11param>)
+            name = "privksklvl11/" + key;
+        else if constexpr (std::is_same_v<P, lvl21param>)
+            name = "privksklvl21/" + key;
+        else if constexpr (std::is_same_v<P, lvl22param>)
+            name = "privksklvl22/" + key;
+        else
+            static_assert(false_v<typename P::targetP::T>,
+                          "Not predefined parameter!");
+        add<PrivateKeySwitchingKey<P>>(
+            name, hashbytes(func.data(), sizeof(func)),
+            [this, func](void* row, const uint64_t i, const Seed& seed) {
+                privkskgenrow<P>(
+                    *static_cast<
+                        typename PrivateKeySwitchingKey<P>::value_type*>(row),
+                    func, sk.key.get<typename P::domainP>(),
+                    sk.key.get<typename P::targetP>(), seed, i);
+            });
+    }
+
+    // The keys of EvalKey::emplaceprivksk4cb.
+    template <class P>
+    void addprivksk4cb()
+    {
+        for (int k = 0; k < P::targetP::k; k++) {
+            Polynomial<typename P::targetP> partkey;
+            for (int i = 0; i < P::targetP::n; i++)
+                partkey[i] =
+                    -sk.key.get<typename P::targetP>()[k * P::targetP::n + i];
+            addprivksk<P>("privksk4cb_" + std::to_string(k), partkey);
+        }
+        addprivksk<P>("privksk4cb_" + std::to_string(P::targetP::k), {1});
+    }
+
+    // Generates the keys added, resuming the job if the progress file of an
+    // earlier run of the same keys exists. blockrows is the number of rows
+    // written at a time; 0 picks about 64 MiB worth. Throws
+    // std::runtime_error on I/O errors or if the progress file is of another
+    // job.
+    void run(const Callback& callback = {}, uint64_t blockrows = 0);
+
+private:
+    using RowGenerator = std::function<void(void*, uint64_t, const Seed&)>;
+
+    struct Component {
+        std::string name;
+        uint64_t rows;
+        uint64_t rowbytes;
+        // Hash of what the rows depend on besides the secret key.
+        uint64_t paramhash;
+        RowGenerator genrow;
+    };
+
+    template <class Key>
+    void add(const std::string& name, const uint64_t paramhash,
+             RowGenerator genrow)
+    {
+        using Row = typename Key::value_type;
+        static_assert(sizeof(Key) == std::tuple_size_v<Key> * sizeof(Row));
+        // The row generators of cloudkey.hpp take int row indices.
+        static_assert(std::tuple_size_v<Key> <=
+                      std::numeric_limits<int>::max());
+        add(Component{name, std::tuple_size_v<Key>, sizeof(Row), paramhash,
+                      std::move(genrow)});
+    }
+    void add(Component component);
+    static uint64_t hashbytes(const void* data, uint64_t size,
+                              uint64_t hash = 0xcbf29ce484222325);
+    uint64_t planhash() const;
+
+    std::string path;
+    SecretKey sk;
+    std::vector<Component> components;
+};
+
+}  // namespace TFHEpp
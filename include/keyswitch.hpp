@@ -1,18 +1,79 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "params.hpp"
 #include "externalproduct.hpp"
+#include "tlwe.hpp"
 #include "utils.hpp"
 
 namespace TFHEpp {
 
+// Runtime settings of the key switching.
+struct KeySwitchConfig {
+    // Number of ciphertexts sharing one pass over the key in
+    // IdentityKeySwitchbatch.
+    int block = 8;
+    // Number of threads the input coefficients are split between. 0 uses the
+    // OpenMP default.
+    int threads = 0;
+    // Number of threads a single IdentityKeySwitch or PrivKeySwitch is split
+    // between when its input has at least parallel_threshold coefficients.
+    // The default 1 keeps it serial; 0 uses the OpenMP default.
+    int latency_threads = 1;
+    int parallel_threshold = 1024;
+};
+inline KeySwitchConfig keyswitchconfig;
+
+inline int keyswitchthreads()
+{
+#ifdef _OPENMP
+    return keyswitchconfig.threads > 0 ? keyswitchconfig.threads
+                                       : omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// Threads for a single key switch of domain_n input coefficients. It stays
+// serial below the threshold and inside a parallel region, where the
+// ciphertexts are already spread over the threads.
+inline int keyswitchlatencythreads([[maybe_unused]] const int domain_n)
+{
+#ifdef _OPENMP
+    if (keyswitchconfig.latency_threads == 1 ||
+        domain_n < keyswitchconfig.parallel_threshold || omp_in_parallel())
+        return 1;
+    return keyswitchconfig.latency_threads > 0 ? keyswitchconfig.latency_threads
+                                               : omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+template <class P>
+void IdentityKeySwitchbatch(TLWE<typename P::targetP> *res,
+                            const TLWE<typename P::domainP> *tlwe,
+                            const int num, const KeySwitchingKey<P> &ksk,
+                            const int threads);
+
 template <class P>
 void IdentityKeySwitch(TLWE<typename P::targetP> &res,
                        const TLWE<typename P::domainP> &tlwe,
                        const KeySwitchingKey<P> &ksk)
 {
+    const int threads =
+        keyswitchlatencythreads(P::domainP::k * P::domainP::n);
+    if (threads > 1) {
+        IdentityKeySwitchbatch<P>(&res, &tlwe, 1, ksk, threads);
+        return;
+    }
     constexpr uint32_t mask = (1U << P::basebit) - 1;
     res = {};
     constexpr uint domain_digit =
@@ -51,6 +112,399 @@ void IdentityKeySwitch(TLWE<typename P::targetP> &res,
     }
 }
 
+// IdentityKeySwitch on the packed key layout. The selected rows are
+// subtracted from a cache-line aligned accumulator of the padded row length,
+// which lets the compiler vectorize the subtraction over whole vectors of
+// targetP::T lanes. The digits are decomposed up front so that the rows
+// selected a few steps ahead can be prefetched.
+template <class P>
+void IdentityKeySwitch(TLWE<typename P::targetP> &res,
+                       const TLWE<typename P::domainP> &tlwe,
+                       const PackedKeySwitchingKey<P> &ksk)
+{
+    constexpr uint32_t mask = (1U << P::basebit) - 1;
+    constexpr uint domain_digit =
+        std::numeric_limits<typename P::domainP::T>::digits;
+    constexpr uint target_digit =
+        std::numeric_limits<typename P::targetP::T>::digits;
+    constexpr typename P::domainP::T prec_offset =
+        (P::basebit * P::t) < domain_digit
+            ? 1ULL << (domain_digit - (1 + P::basebit * P::t))
+            : 0;
+    constexpr uint32_t rowlen = packedksrowlen<P>();
+    constexpr uint32_t numrows = P::domainP::k * P::domainP::n * P::t;
+    constexpr uint32_t prefetch_distance = 4;
+
+    alignas(64) std::array<uint8_t, numrows> digits;
+    for (int i = 0; i < P::domainP::k * P::domainP::n; i++) {
+        const typename P::domainP::T aibar = tlwe[i] + prec_offset;
+        for (int j = 0; j < P::t; j++)
+            digits[i * P::t + j] =
+                (aibar >> (domain_digit - (j + 1) * P::basebit)) & mask;
+    }
+
+    alignas(64) PackedKeySwitchingKeyRow<P> acc = {};
+    if constexpr (domain_digit == target_digit)
+        acc[P::targetP::k * P::targetP::n] =
+            tlwe[P::domainP::k * P::domainP::n];
+    else if constexpr (domain_digit > target_digit)
+        acc[P::targetP::k * P::targetP::n] =
+            (tlwe[P::domainP::k * P::domainP::n] +
+             (1ULL << (domain_digit - target_digit - 1))) >>
+            (domain_digit - target_digit);
+    else if constexpr (domain_digit < target_digit)
+        acc[P::targetP::k * P::targetP::n] =
+            static_cast<typename P::targetP::T>(
+                tlwe[P::domainP::k * P::domainP::n])
+            << (target_digit - domain_digit);
+
+    for (uint32_t r = 0; r < numrows; r++) {
+        if (r + prefetch_distance < numrows) {
+            const uint32_t next = r + prefetch_distance;
+            const uint32_t aij = digits[next];
+            if (aij != 0) {
+                const auto *row = ksk[next / P::t][next % P::t][aij - 1].data();
+                for (uint32_t l = 0; l < rowlen;
+                     l += 64 / sizeof(typename P::targetP::T))
+                    __builtin_prefetch(row + l);
+            }
+        }
+        const uint32_t aij = digits[r];
+        if (aij == 0) continue;
+        const PackedKeySwitchingKeyRow<P> &row = ksk[r / P::t][r % P::t][aij - 1];
+        for (uint32_t l = 0; l < rowlen; l++) acc[l] -= row[l];
+    }
+    std::copy(acc.begin(), acc.begin() + P::targetP::k * P::targetP::n + 1,
+              res.begin());
+}
+
+// IdentityKeySwitch on a SeededKeySwitchingKey. Each selected row is expanded
+// from the seed right before it is subtracted, so the full key never has to
+// be resident. This trades a PRNG expansion per row for the memory traffic of
+// the expanded key; use EvalKey::emplaceseediksk2iksk to expand it once
+// instead when the key is used repeatedly.
+template <class P>
+void IdentityKeySwitch(TLWE<typename P::targetP> &res,
+                       const TLWE<typename P::domainP> &tlwe,
+                       const SeededKeySwitchingKey<P> &ksk)
+{
+    constexpr uint32_t mask = (1U << P::basebit) - 1;
+    res = {};
+    constexpr uint domain_digit =
+        std::numeric_limits<typename P::domainP::T>::digits;
+    constexpr uint target_digit =
+        std::numeric_limits<typename P::targetP::T>::digits;
+    constexpr typename P::domainP::T prec_offset =
+        (P::basebit * P::t) < domain_digit
+            ? 1ULL << (domain_digit - (1 + P::basebit * P::t))
+            : 0;
+
+    if constexpr (domain_digit == target_digit)
+        res[P::targetP::k * P::targetP::n] =
+            tlwe[P::domainP::k * P::domainP::n];
+    else if constexpr (domain_digit > target_digit)
+        res[P::targetP::k * P::targetP::n] =
+            (tlwe[P::domainP::k * P::domainP::n] +
+             (1ULL << (domain_digit - target_digit - 1))) >>
+            (domain_digit - target_digit);
+    else if constexpr (domain_digit < target_digit)
+        res[P::targetP::k * P::targetP::n] =
+            static_cast<typename P::targetP::T>(
+                tlwe[P::domainP::k * P::domainP::n])
+            << (target_digit - domain_digit);
+    TLWE<typename P::targetP> row;
+    for (int i = 0; i < P::domainP::k * P::domainP::n; i++) {
+        const typename P::domainP::T aibar = tlwe[i] + prec_offset;
+        for (int j = 0; j < P::t; j++) {
+            const uint32_t aij =
+                (aibar >> (domain_digit - (j + 1) * P::basebit)) & mask;
+            if (aij == 0) continue;
+            tlweSeededMask<typename P::targetP>(
+                row, ksk.seed, seededksindex<P>(i, j, aij - 1));
+            row[P::targetP::k * P::targetP::n] = ksk.b[i][j][aij - 1];
+            for (int k = 0; k <= P::targetP::k * P::targetP::n; k++)
+                res[k] -= row[k];
+        }
+    }
+}
+
+// IdentityKeySwitch on a key stored at bits bits per coefficient. The planes
+// of each row are widened while they are accumulated, so only the quantized
+// bytes cross the memory bus.
+template <class P, uint32_t bits = P::quantizedbits>
+void IdentityKeySwitch(TLWE<typename P::targetP> &res,
+                       const TLWE<typename P::domainP> &tlwe,
+                       const QuantizedKeySwitchingKey<P, bits> &ksk)
+{
+    constexpr uint32_t mask = (1U << P::basebit) - 1;
+    constexpr uint domain_digit =
+        std::numeric_limits<typename P::domainP::T>::digits;
+    constexpr uint target_digit =
+        std::numeric_limits<typename P::targetP::T>::digits;
+    constexpr typename P::domainP::T prec_offset =
+        (P::basebit * P::t) < domain_digit
+            ? 1ULL << (domain_digit - (1 + P::basebit * P::t))
+            : 0;
+    using Row = QuantizedKeySwitchingKeyRow<P, bits>;
+    using T = typename P::targetP::T;
+    constexpr uint32_t numrows = P::domainP::k * P::domainP::n * P::t;
+    constexpr uint32_t prefetch_distance = 4;
+
+    alignas(64) std::array<uint8_t, numrows> digits;
+    for (int i = 0; i < P::domainP::k * P::domainP::n; i++) {
+        const typename P::domainP::T aibar = tlwe[i] + prec_offset;
+        for (int j = 0; j < P::t; j++)
+            digits[i * P::t + j] =
+                (aibar >> (domain_digit - (j + 1) * P::basebit)) & mask;
+    }
+
+    // Accumulated in a local buffer, which the key planes cannot alias.
+    alignas(64) std::array<T, Row::len> acc = {};
+    if constexpr (domain_digit == target_digit)
+        acc[P::targetP::k * P::targetP::n] =
+            tlwe[P::domainP::k * P::domainP::n];
+    else if constexpr (domain_digit > target_digit)
+        acc[P::targetP::k * P::targetP::n] =
+            (tlwe[P::domainP::k * P::domainP::n] +
+             (1ULL << (domain_digit - target_digit - 1))) >>
+            (domain_digit - target_digit);
+    else if constexpr (domain_digit < target_digit)
+        acc[P::targetP::k * P::targetP::n] =
+            static_cast<typename P::targetP::T>(
+                tlwe[P::domainP::k * P::domainP::n])
+            << (target_digit - domain_digit);
+
+    constexpr uint32_t shift = Row::digits - bits;
+    for (uint32_t r = 0; r < numrows; r++) {
+        if (r + prefetch_distance < numrows) {
+            const uint32_t next = r + prefetch_distance;
+            const uint32_t aij = digits[next];
+            if (aij != 0) {
+                const char *row = reinterpret_cast<const char *>(
+                    &ksk[next / P::t][next % P::t][aij - 1]);
+                for (uint32_t l = 0; l < sizeof(Row); l += 64)
+                    __builtin_prefetch(row + l);
+            }
+        }
+        const uint32_t aij = digits[r];
+        if (aij == 0) continue;
+        const Row &row = ksk[r / P::t][r % P::t][aij - 1];
+        const uint16_t *__restrict hi = row.hi.data();
+        const uint8_t *__restrict mid = row.mid.data();
+        const uint8_t *__restrict lo = row.lo.data();
+        T *__restrict a = acc.data();
+        // All the planes of a coefficient are combined before the one
+        // subtraction, so each row is a single pass over the accumulator.
+        const auto subtract = [&](const uint32_t l, const T nibble) {
+            T v = nibble;
+            if constexpr (Row::hibits != 0)
+                v |= static_cast<T>(hi[l]) << (Row::digits - Row::hibits);
+            if constexpr (Row::midbits != 0)
+                v |= static_cast<T>(mid[l])
+                     << (Row::digits - Row::hibits - Row::midbits);
+            a[l] -= v;
+        };
+        if constexpr (Row::lobits != 0) {
+            for (uint32_t l = 0; l < Row::half; l++)
+                subtract(l, static_cast<T>(lo[l] & 0xF) << shift);
+            for (uint32_t l = Row::half; l < Row::len; l++)
+                subtract(l, static_cast<T>(lo[l - Row::half] & 0xF0)
+                                << (shift - 4));
+        }
+        else
+            for (uint32_t l = 0; l < Row::len; l++) subtract(l, 0);
+    }
+    std::copy(acc.begin(), acc.begin() + Row::len, res.begin());
+}
+
+// Standard deviations, as fractions of the torus, of the noise that
+// IdentityKeySwitch adds: from the noise of the key, from dropping the input
+// bits below basebit * t and from storing the key at bits bits. About
+// (1 - 2^-basebit) of the kn * t digits select a row.
+struct KeySwitchNoise {
+    double key;
+    double approx;
+    double quantization;
+    double total() const
+    {
+        return std::sqrt(key * key + approx * approx +
+                         quantization * quantization);
+    }
+};
+
+// E[s^2] of a key coefficient drawn uniformly from the key values of P.
+template <class P>
+constexpr double keysquaremean()
+{
+    double sum = 0;
+    for (int32_t v = P::key_value_min; v <= P::key_value_max; v++)
+        sum += static_cast<double>(v) * v;
+    return sum / (P::key_value_max - P::key_value_min + 1);
+}
+
+template <class P>
+KeySwitchNoise identitykeyswitchnoise(
+    const uint32_t bits =
+        std::numeric_limits<typename P::targetP::T>::digits)
+{
+    constexpr uint domain_digit =
+        std::numeric_limits<typename P::domainP::T>::digits;
+    constexpr uint target_digit =
+        std::numeric_limits<typename P::targetP::T>::digits;
+    const double rows = static_cast<double>(P::domainP::k * P::domainP::n) *
+                        P::t * (1.0 - std::ldexp(1.0, -P::basebit));
+    KeySwitchNoise noise;
+    noise.key = std::sqrt(rows) * P::alpha;
+    noise.approx =
+        (P::basebit * P::t) < domain_digit
+            ? std::sqrt(P::domainP::k * P::domainP::n *
+                        keysquaremean<typename P::domainP>() / 12.0) *
+                  std::ldexp(1.0, -static_cast<int>(P::basebit * P::t))
+            : 0;
+    noise.quantization =
+        bits < target_digit
+            ? std::sqrt(rows *
+                        (1 + P::targetP::k * P::targetP::n *
+                                 keysquaremean<typename P::targetP>()) /
+                        12.0) *
+                  std::ldexp(1.0, -static_cast<int>(bits))
+            : 0;
+    return noise;
+}
+
+// IdentityKeySwitch fused with the modulus switch of the blind rotation by
+// brP. The mask is accumulated as usual, but the body is kept at the wider of
+// the two widths and switched to 2N directly, so it is rounded once instead
+// of twice. The result feeds BlindRotate<brP, num_out> without materializing
+// the TLWE<iksP::targetP>.
+template <class iksP, class brP, uint32_t num_out = 1>
+void IdentityKeySwitchModSwitch(RotationIndices<brP> &idx,
+                                const TLWE<typename iksP::domainP> &tlwe,
+                                const KeySwitchingKey<iksP> &ksk)
+{
+    static_assert(
+        std::is_same_v<typename iksP::targetP, typename brP::domainP>,
+        "The key switch must output the domain of the blind rotation!");
+    using targetT = typename iksP::targetP::T;
+    constexpr uint32_t mask = (1U << iksP::basebit) - 1;
+    constexpr uint domain_digit =
+        std::numeric_limits<typename iksP::domainP::T>::digits;
+    constexpr uint target_digit = std::numeric_limits<targetT>::digits;
+    using bodyT = std::conditional_t<(domain_digit > target_digit),
+                                     typename iksP::domainP::T, targetT>;
+    constexpr uint body_digit = std::numeric_limits<bodyT>::digits;
+    constexpr typename iksP::domainP::T prec_offset =
+        (iksP::basebit * iksP::t) < domain_digit
+            ? 1ULL << (domain_digit - (1 + iksP::basebit * iksP::t))
+            : 0;
+    constexpr int domain_n = iksP::domainP::k * iksP::domainP::n;
+    constexpr int target_n = iksP::targetP::k * iksP::targetP::n;
+    constexpr uint32_t bitwidth = bits_needed<num_out - 1>();
+
+    alignas(64) std::array<targetT, target_n> acc = {};
+    bodyT body = static_cast<bodyT>(tlwe[domain_n])
+                 << (body_digit - domain_digit);
+    for (int i = 0; i < domain_n; i++) {
+        const typename iksP::domainP::T aibar = tlwe[i] + prec_offset;
+        for (int j = 0; j < iksP::t; j++) {
+            const uint32_t aij =
+                (aibar >> (domain_digit - (j + 1) * iksP::basebit)) & mask;
+            if (aij == 0) continue;
+            const TLWE<typename iksP::targetP> &row = ksk[i][j][aij - 1];
+            for (int l = 0; l < target_n; l++) acc[l] -= row[l];
+            body -= static_cast<bodyT>(row[target_n])
+                    << (body_digit - target_digit);
+        }
+    }
+
+    constexpr targetT roundoffset =
+        1ULL << (target_digit - 2 - brP::targetP::nbit + bitwidth);
+    for (int l = 0; l < target_n; l++)
+        idx[l] = (acc[l] + roundoffset) >>
+                 (target_digit - 1 - brP::targetP::nbit + bitwidth)
+                     << bitwidth;
+    idx[target_n] =
+        2 * brP::targetP::n -
+        ((body >> (body_digit - 1 - brP::targetP::nbit + bitwidth))
+         << bitwidth);
+}
+
+// SampleExtractIndex fused with IdentityKeySwitch. The coefficients of the
+// extracted TLWE are read directly from the polynomials of the TRLWE, so it
+// is never materialized.
+template <class P>
+void SampleExtractIndexKeySwitch(
+    TLWE<typename P::targetP> &res,
+    const std::array<const Polynomial<typename P::domainP> *,
+                     P::domainP::k + 1> &trlwe,
+    const int index, const KeySwitchingKey<P> &ksk)
+{
+    constexpr uint32_t mask = (1U << P::basebit) - 1;
+    res = {};
+    constexpr uint domain_digit =
+        std::numeric_limits<typename P::domainP::T>::digits;
+    constexpr uint target_digit =
+        std::numeric_limits<typename P::targetP::T>::digits;
+    constexpr typename P::domainP::T prec_offset =
+        (P::basebit * P::t) < domain_digit
+            ? 1ULL << (domain_digit - (1 + P::basebit * P::t))
+            : 0;
+
+    const typename P::domainP::T b = (*trlwe[P::domainP::k])[index];
+    if constexpr (domain_digit == target_digit)
+        res[P::targetP::k * P::targetP::n] = b;
+    else if constexpr (domain_digit > target_digit)
+        res[P::targetP::k * P::targetP::n] =
+            (b + (1ULL << (domain_digit - target_digit - 1))) >>
+            (domain_digit - target_digit);
+    else if constexpr (domain_digit < target_digit)
+        res[P::targetP::k * P::targetP::n] =
+            static_cast<typename P::targetP::T>(b)
+            << (target_digit - domain_digit);
+    for (int k = 0; k < P::domainP::k; k++)
+        for (int i = 0; i < P::domainP::n; i++) {
+            const typename P::domainP::T ai =
+                i <= index ? (*trlwe[k])[index - i]
+                           : -(*trlwe[k])[P::domainP::n + index - i];
+            const typename P::domainP::T aibar = ai + prec_offset;
+            for (int j = 0; j < P::t; j++) {
+                const uint32_t aij =
+                    (aibar >> (domain_digit - (j + 1) * P::basebit)) & mask;
+                if (aij != 0)
+                    for (int l = 0; l <= P::targetP::k * P::targetP::n; l++)
+                        res[l] -= ksk[k * P::domainP::n + i][j][aij - 1][l];
+            }
+        }
+}
+
+template <class P>
+void SampleExtractIndexKeySwitch(TLWE<typename P::targetP> &res,
+                                 const TRLWE<typename P::domainP> &trlwe,
+                                 const int index,
+                                 const KeySwitchingKey<P> &ksk)
+{
+    std::array<const Polynomial<typename P::domainP> *, P::domainP::k + 1>
+        polys;
+    for (int k = 0; k <= P::domainP::k; k++) polys[k] = &trlwe[k];
+    SampleExtractIndexKeySwitch<P>(res, polys, index, ksk);
+}
+
+template <class P, int batch>
+void SampleExtractIndexKeySwitchbatch(
+    TLWEn<typename P::targetP, batch> &res,
+    const TRLWEn<typename P::domainP, batch> &trlwe, const int index,
+    const KeySwitchingKey<P> &ksk)
+{
+    TFHEPP_OMP(parallel for)
+    for (int j = 0; j < batch; j++) {
+        std::array<const Polynomial<typename P::domainP> *,
+                   P::domainP::k + 1>
+            polys;
+        for (int k = 0; k <= P::domainP::k; k++) polys[k] = &trlwe[k][j];
+        SampleExtractIndexKeySwitch<P>(res[j], polys, index, ksk);
+    }
+}
+
 template <class P, uint numcat>
 void CatIdentityKeySwitch(
     std::array<TLWE<typename P::targetP>, numcat> &res,
@@ -102,6 +556,94 @@ void CatIdentityKeySwitch(
     }
 }
 
+// IdentityKeySwitch of num ciphertexts. They are processed in blocks of
+// keyswitchconfig.block and the key is walked once per block, so every row
+// fetched is used by all the ciphertexts of the block that select it. The
+// input coefficients are split between the threads, each of which
+// accumulates a partial result per ciphertext; the partials are summed at the
+// end.
+template <class P>
+void IdentityKeySwitchbatch(TLWE<typename P::targetP> *res,
+                            const TLWE<typename P::domainP> *tlwe,
+                            const int num, const KeySwitchingKey<P> &ksk,
+                            const int threads)
+{
+    constexpr uint32_t mask = (1U << P::basebit) - 1;
+    constexpr uint domain_digit =
+        std::numeric_limits<typename P::domainP::T>::digits;
+    constexpr uint target_digit =
+        std::numeric_limits<typename P::targetP::T>::digits;
+    constexpr typename P::domainP::T prec_offset =
+        (P::basebit * P::t) < domain_digit
+            ? 1ULL << (domain_digit - (1 + P::basebit * P::t))
+            : 0;
+    constexpr int domain_n = P::domainP::k * P::domainP::n;
+    constexpr int target_n = P::targetP::k * P::targetP::n;
+    const int block = std::clamp(keyswitchconfig.block, 1, std::max(num, 1));
+    const int parts = std::clamp(threads, 1, domain_n);
+
+    // Kept by the calling thread between calls, so a key switch per gate does
+    // not allocate. The threads of the region write through the pointer.
+    static thread_local std::vector<TLWE<typename P::targetP>> partialbuf;
+    if (partialbuf.size() < static_cast<size_t>(parts * block))
+        partialbuf.resize(parts * block);
+    TLWE<typename P::targetP> *const partial = partialbuf.data();
+    for (int start = 0; start < num; start += block) {
+        const int size = std::min(block, num - start);
+        TFHEPP_OMP(parallel for num_threads(parts))
+        for (int th = 0; th < parts; th++) {
+            TLWE<typename P::targetP> *acc = &partial[th * block];
+            for (int c = 0; c < size; c++) acc[c] = {};
+            const int end = domain_n * (th + 1) / parts;
+            for (int i = domain_n * th / parts; i < end; i++)
+                for (int j = 0; j < P::t; j++)
+                    for (int c = 0; c < size; c++) {
+                        const typename P::domainP::T aibar =
+                            tlwe[start + c][i] + prec_offset;
+                        const uint32_t aij =
+                            (aibar >> (domain_digit - (j + 1) * P::basebit)) &
+                            mask;
+                        if (aij != 0)
+                            for (int l = 0; l <= target_n; l++)
+                                acc[c][l] -= ksk[i][j][aij - 1][l];
+                    }
+        }
+        for (int c = 0; c < size; c++) {
+            TLWE<typename P::targetP> &out = res[start + c];
+            out = partial[c];
+            for (int th = 1; th < parts; th++)
+                for (int l = 0; l <= target_n; l++)
+                    out[l] += partial[th * block + c][l];
+            const typename P::domainP::T b = tlwe[start + c][domain_n];
+            if constexpr (domain_digit == target_digit)
+                out[target_n] += b;
+            else if constexpr (domain_digit > target_digit)
+                out[target_n] +=
+                    (b + (1ULL << (domain_digit - target_digit - 1))) >>
+                    (domain_digit - target_digit);
+            else if constexpr (domain_digit < target_digit)
+                out[target_n] += static_cast<typename P::targetP::T>(b)
+                                 << (target_digit - domain_digit);
+        }
+    }
+}
+
+template <class P>
+void IdentityKeySwitchbatch(TLWE<typename P::targetP> *res,
+                            const TLWE<typename P::domainP> *tlwe,
+                            const int num, const KeySwitchingKey<P> &ksk)
+{
+    IdentityKeySwitchbatch<P>(res, tlwe, num, ksk, keyswitchthreads());
+}
+
+template <class P, int batch>
+void IdentityKeySwitchbatch(TLWEn<typename P::targetP, batch> &res,
+                            const TLWEn<typename P::domainP, batch> &tlwe,
+                            const KeySwitchingKey<P> &ksk)
+{
+    IdentityKeySwitchbatch<P>(res.data(), tlwe.data(), batch, ksk);
+}
+
 template <class P>
 void SubsetIdentityKeySwitch(TLWE<typename P::targetP> &res,
                              const TLWE<typename P::domainP> &tlwe,
@@ -192,33 +734,194 @@ void TLWE2TRLWEIKS(TRLWE<typename P::targetP> &res,
     }
 }
 
+// Only the mask of τ_d(trlwe) is decomposed. The body term of the external
+// product would decompose the zero polynomial, so it is skipped. res may
+// alias trlwe.
 template <class P>
-void EvalAuto(TRLWE<P> &res, const TRLWE<P> &trlwe, const int d,
-              const TRGSWFFT<P> &autokey)
+void EvalAuto(TRLWE<P> &res, const TRLWE<P> &trlwe,
+              const AutomorphismTable<P> &table, const TRGSWFFT<P> &autokey)
 {
-    Polynomial<P> polyb;
-    Automorphism<P>(polyb, trlwe[1], d);
-    res = {};
-    Automorphism<P>(res[1], trlwe[0], d);
-    trgswfftExternalProduct<P>(res, res, autokey);
+    static_assert(P::k == 1, "EvalAuto supports only k = 1!");
+    alignas(64) Polynomial<P> polya, polyb;
+    Automorphism<P>(polya, trlwe[0], table);
+    Automorphism<P>(polyb, trlwe[1], table);
+    alignas(64) DecomposedPolynomial<P> decpoly;
+    Decomposition<P>(decpoly, polya);
+    alignas(64) PolynomialInFD<P> decpolyfft;
+    alignas(64) TRLWEInFD<P> restrlwefft;
+    TwistIFFT<P>(decpolyfft, decpoly[0]);
+    for (int m = 0; m < P::k + 1; m++)
+        MulInFD<P::n>(restrlwefft[m], decpolyfft, autokey[P::l][m]);
+    for (int i = 1; i < P::l; i++) {
+        TwistIFFT<P>(decpolyfft, decpoly[i]);
+        for (int m = 0; m < P::k + 1; m++)
+            FMAInFD<P::n>(restrlwefft[m], decpolyfft, autokey[i + P::l][m]);
+    }
+    for (int m = 0; m < P::k + 1; m++) TwistFFT<P>(res[m], restrlwefft[m]);
     for (int i = 0; i < P::n; i++) {
         res[0][i] = -res[0][i];
         res[1][i] = polyb[i] - res[1][i];
     }
 }
 
+template <class P>
+void EvalAuto(TRLWE<P> &res, const TRLWE<P> &trlwe, const int d,
+              const TRGSWFFT<P> &autokey)
+{
+    AutomorphismTable<P> buf;
+    EvalAuto<P>(res, trlwe, automorphismtable<P>(buf, d), autokey);
+}
+
+// Applies num automorphisms to the same TRLWE. The mask is decomposed and
+// transformed once, and τ_d[f] is applied to the transformed digits, so every
+// further automorphism costs only the products in the Fourier domain and the
+// two forward transforms. τ_d(decomposition of a) is a decomposition of
+// τ_d(a) with the same digit bound but not necessarily the one that
+// Decomposition returns, so the result may differ from EvalAuto within the
+// noise.
+template <class P, uint num>
+void EvalAutoHoisted(std::array<TRLWE<P>, num> &res, const TRLWE<P> &trlwe,
+                     const std::array<int, num> &d,
+                     const std::array<const TRGSWFFT<P> *, num> &autokey)
+{
+    static_assert(P::k == 1, "EvalAuto supports only k = 1!");
+    alignas(64) DecomposedPolynomial<P> decpoly;
+    Decomposition<P>(decpoly, trlwe[0]);
+    alignas(64) std::array<PolynomialInFD<P>, P::l> decpolyfft;
+    for (int i = 0; i < P::l; i++) TwistIFFT<P>(decpolyfft[i], decpoly[i]);
+
+    for (uint f = 0; f < num; f++) {
+        AutomorphismTable<P> buf;
+        AutomorphismInFDTable<P> fdbuf;
+        const AutomorphismTable<P> &table = automorphismtable<P>(buf, d[f]);
+        const AutomorphismInFDTable<P> &fdtable =
+            automorphisminfdtable<P>(fdbuf, d[f]);
+        alignas(64) PolynomialInFD<P> autofft;
+        alignas(64) TRLWEInFD<P> restrlwefft;
+        for (int i = 0; i < P::l; i++) {
+            AutomorphismInFD<P>(autofft, decpolyfft[i], fdtable);
+            for (int m = 0; m < P::k + 1; m++)
+                if (i == 0)
+                    MulInFD<P::n>(restrlwefft[m], autofft,
+                                  (*autokey[f])[P::l][m]);
+                else
+                    FMAInFD<P::n>(restrlwefft[m], autofft,
+                                  (*autokey[f])[i + P::l][m]);
+        }
+        for (int m = 0; m < P::k + 1; m++)
+            TwistFFT<P>(res[f][m], restrlwefft[m]);
+        alignas(64) Polynomial<P> polyb;
+        Automorphism<P>(polyb, trlwe[1], table);
+        for (int i = 0; i < P::n; i++) {
+            res[f][0][i] = -res[f][0][i];
+            res[f][1][i] = polyb[i] - res[f][1][i];
+        }
+    }
+}
+
+// Applies the same automorphism to num TRLWEs, so the key and the tables
+// stay in cache across the batch.
+template <class P>
+void EvalAutobatch(TRLWE<P> *res, const TRLWE<P> *trlwe, const int num,
+                   const int d, const TRGSWFFT<P> &autokey)
+{
+    AutomorphismTable<P> buf;
+    const AutomorphismTable<P> &table = automorphismtable<P>(buf, d);
+    TFHEPP_OMP(parallel for if (num > 1))
+    for (int j = 0; j < num; j++)
+        EvalAuto<P>(res[j], trlwe[j], table, autokey);
+}
+
 template <class P>
 void AnnihilateKeySwitching(TRLWE<P> &res, const TRLWE<P> &trlwe,
                             const AnnihilateKey<P> &ahk)
 {
+    const AnnihilationTables<P> &tables = annihilationtables<P>();
     res = trlwe;
     for (int i = 0; i < P::nbit; i++) {
-        TRLWE<P> evaledauto;
-        EvalAuto<P>(evaledauto, res, (1 << (P::nbit - i)) + 1, ahk[i]);
+        alignas(64) TRLWE<P> evaledauto;
+        EvalAuto<P>(evaledauto, res, tables.coef[P::nbit - i], ahk[i]);
         for (int j = 0; j < 2 * P::n; j++) res[0][j] += evaledauto[0][j];
     }
 }
 
+// Annihilates num TRLWEs level by level, so each key of ahk is used for the
+// whole batch before the next one is loaded.
+template <class P>
+void AnnihilateKeySwitchingbatch(TRLWE<P> *res, const TRLWE<P> *trlwe,
+                                 const int num, const AnnihilateKey<P> &ahk)
+{
+    const AnnihilationTables<P> &tables = annihilationtables<P>();
+    for (int j = 0; j < num; j++) res[j] = trlwe[j];
+    for (int i = 0; i < P::nbit; i++) {
+        TFHEPP_OMP(parallel for if (num > 1))
+        for (int j = 0; j < num; j++) {
+            alignas(64) TRLWE<P> evaledauto;
+            EvalAuto<P>(evaledauto, res[j], tables.coef[P::nbit - i], ahk[i]);
+            for (int k = 0; k < 2 * P::n; k++)
+                res[j][0][k] += evaledauto[0][k];
+        }
+    }
+}
+
+// Packs num TLWEs into one TRLWE with the automorphism-based packing key
+// switch. tlwe[j] must be under the key of the TRLWE; its message lands on
+// coefficient j * N / 2^ceil(log2(num)) and every other coefficient is
+// annihilated. Each step of the packing tree doubles the phase, so the
+// inputs are divided by N beforehand, which costs only a rounding error of
+// the size of the key.
+template <class P, uint num>
+void TLWE2TRLWEPacking(TRLWE<P> &res, const std::array<TLWE<P>, num> &tlwe,
+                       const AnnihilateKey<P> &ahk)
+{
+    static_assert(P::k == 1, "EvalAuto supports only k = 1!");
+    static_assert(num > 0 && num <= P::n, "Too many TLWEs to pack!");
+    constexpr uint depth = bits_needed<num - 1>();
+    constexpr uint packed = 1U << depth;
+    constexpr typename P::T halfN = 1ULL << (P::nbit - 1);
+
+    std::vector<TRLWE<P>> trlwe(packed);
+    for (uint j = 0; j < num; j++) {
+        // Inverse of SampleExtractIndex at index 0.
+        trlwe[j][0][0] = (tlwe[j][0] + halfN) >> P::nbit;
+        for (int i = 1; i < P::n; i++)
+            trlwe[j][0][P::n - i] = -((tlwe[j][i] + halfN) >> P::nbit);
+        trlwe[j][1] = {};
+        trlwe[j][1][0] = (tlwe[j][P::n] + halfN) >> P::nbit;
+    }
+
+    // Level l merges trlwe[j] and trlwe[j + half], placing the latter
+    // N / 2^l coefficients further.
+    for (uint l = 1; l <= depth; l++) {
+        const uint half = packed >> l;
+        TFHEPP_OMP(parallel for)
+        for (uint j = 0; j < half; j++) {
+            TRLWE<P> &even = trlwe[j];
+            TRLWE<P> rotated, diff, evaledauto;
+            for (int k = 0; k < P::k + 1; k++) {
+                PolynomialMulByXai<P>(rotated[k], trlwe[j + half][k],
+                                      P::n >> l);
+                for (int i = 0; i < P::n; i++) {
+                    diff[k][i] = even[k][i] - rotated[k][i];
+                    even[k][i] += rotated[k][i];
+                }
+            }
+            EvalAuto<P>(evaledauto, diff, (1 << l) + 1, ahk[P::nbit - l]);
+            for (int k = 0; k < P::k + 1; k++)
+                for (int i = 0; i < P::n; i++) even[k][i] += evaledauto[k][i];
+        }
+    }
+
+    // The remaining levels clear the coefficients between the messages.
+    res = trlwe[0];
+    for (uint l = depth + 1; l <= P::nbit; l++) {
+        TRLWE<P> evaledauto;
+        EvalAuto<P>(evaledauto, res, (1 << l) + 1, ahk[P::nbit - l]);
+        for (int k = 0; k < P::k + 1; k++)
+            for (int i = 0; i < P::n; i++) res[k][i] += evaledauto[k][i];
+    }
+}
+
 template <class P, uint num_func>
 void AnnihilatePrivateKeySwitching(
     std::array<TRLWE<P>, num_func> &res, const TRLWE<P> &trlwe,
@@ -234,12 +937,48 @@ void AnnihilatePrivateKeySwitching(
         for (int j = 0; j < 2 * P::n; j++)
             res[num_func - 1][0][j] += evaledauto[0][j];
     }
+    // All of the private key switches act on the same TRLWE, so its
+    // decomposition is shared.
+    std::array<int, num_func> d;
+    std::array<const TRGSWFFT<P> *, num_func> keys;
     for (int i = 0; i < num_func; i++) {
-        TRLWE<P> evaledauto;
-        EvalAuto<P>(evaledauto, res[num_func - 1], (1 << (P::nbit - i)) + 1,
-                    privks[i]);
+        d[i] = (1 << (P::nbit - i)) + 1;
+        keys[i] = &privks[i];
+    }
+    std::unique_ptr<std::array<TRLWE<P>, num_func>> evaledauto =
+        std::make_unique<std::array<TRLWE<P>, num_func>>();
+    EvalAutoHoisted<P, num_func>(*evaledauto, res[num_func - 1], d, keys);
+    for (int i = 0; i < num_func; i++)
         for (int j = 0; j < 2 * P::n; j++)
-            res[i][0][j] += res[num_func - 1][0][j] + evaledauto[0][j];
+            res[i][0][j] += res[num_func - 1][0][j] + (*evaledauto)[i][0][j];
+}
+
+// Subtracts privksk[i][j][digits[i * t + j] - 1] from res for every nonzero
+// digit. The coefficients of res are split into contiguous slices, one per
+// thread, and every thread subtracts its slice of each selected row, so the
+// threads never write the same word and no reduction is needed. The inner
+// loop runs over consecutive coefficients of one polynomial and vectorizes.
+template <class P, class PrivKey, size_t numdigits>
+void PrivKeySwitchDigits(TRLWE<typename P::targetP> &res,
+                         const std::array<uint8_t, numdigits> &digits,
+                         const PrivKey &privksk)
+{
+    constexpr int n = P::targetP::n;
+    const int threads =
+        std::clamp(keyswitchlatencythreads(numdigits / P::t), 1, n);
+    res = {};
+    TFHEPP_OMP(parallel for num_threads(threads))
+    for (int th = 0; th < threads; th++) {
+        const int begin = n * th / threads;
+        const int end = n * (th + 1) / threads;
+        for (size_t r = 0; r < numdigits; r++) {
+            const uint32_t aij = digits[r];
+            if (aij == 0) continue;
+            const TRLWE<typename P::targetP> &row =
+                privksk[r / P::t][r % P::t][aij - 1];
+            for (int k = 0; k < P::targetP::k + 1; k++)
+                for (int p = begin; p < end; p++) res[k][p] -= row[k][p];
+        }
     }
 }
 
@@ -252,24 +991,18 @@ void PrivKeySwitch(TRLWE<typename P::targetP> &res,
     constexpr uint64_t prec_offset =
         1ULL << (std::numeric_limits<typename P::domainP::T>::digits -
                  (1 + P::basebit * P::t));
+    constexpr int numin = P::domainP::k * P::domainP::n + 1;
 
-    res = {};
-    for (int i = 0; i <= P::domainP::k * P::domainP::n; i++) {
+    alignas(64) std::array<uint8_t, numin * P::t> digits;
+    for (int i = 0; i < numin; i++) {
         const typename P::domainP::T aibar = tlwe[i] + prec_offset;
-
-        for (int j = 0; j < P::t; j++) {
-            const typename P::domainP::T aij =
+        for (int j = 0; j < P::t; j++)
+            digits[i * P::t + j] =
                 (aibar >> (std::numeric_limits<typename P::domainP::T>::digits -
                            (j + 1) * P::basebit)) &
                 mask;
-
-            if (aij != 0) {
-                for (int k = 0; k < P::targetP::k + 1; k++)
-                    for (int p = 0; p < P::targetP::n; p++)
-                        res[k][p] -= privksk[i][j][aij - 1][k][p];
-            }
-        }
     }
+    PrivKeySwitchDigits<P>(res, digits, privksk);
 }
 
 template <class P>
@@ -281,24 +1014,18 @@ void SubsetPrivKeySwitch(TRLWE<typename P::targetP> &res,
     constexpr uint64_t prec_offset =
         1ULL << (std::numeric_limits<typename P::targetP::T>::digits -
                  (1 + P::basebit * P::t));
+    constexpr int numin = P::targetP::k * P::targetP::n + 1;
 
-    res = {};
-    for (int i = 0; i <= P::targetP::k * P::targetP::n; i++) {
+    alignas(64) std::array<uint8_t, numin * P::t> digits;
+    for (int i = 0; i < numin; i++) {
         const typename P::targetP::T aibar = tlwe[i] + prec_offset;
-
-        for (int j = 0; j < P::t; j++) {
-            const typename P::domainP::T aij =
-                (aibar >> (std::numeric_limits<typename P::domainP::T>::digits -
+        for (int j = 0; j < P::t; j++)
+            digits[i * P::t + j] =
+                (aibar >> (std::numeric_limits<typename P::targetP::T>::digits -
                            (j + 1) * P::basebit)) &
                 mask;
-
-            if (aij != 0) {
-                for (int p = 0; p < P::targetP::n; p++)
-                    for (int k = 0; k < P::targetP::k + 1; k++)
-                        res[k][p] -= privksk[i][j][aij - 1][k][p];
-            }
-        }
     }
+    PrivKeySwitchDigits<P>(res, digits, privksk);
 }
 
 }  // namespace TFHEpp
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 #include <limits>
 
 #include "params.hpp"
@@ -46,6 +47,7 @@ struct portablelvl1param {
           l(lvl1param::l),
           Bgbit(lvl1param::Bgbit),
           Bg(lvl1param::Bg),
+          alpha(lvl1param::alpha),
           approx_bit(std::numeric_limits<typename lvl1param::T>::digits)
     {
     }
@@ -71,7 +73,7 @@ struct portablelvl2param {
     std::uint32_t l;
     std::uint32_t Bgbit;
     std::uint32_t Bg;
-    // double alpha;                  // fresh noise
+    double alpha;              // fresh noise, not serialized
     std::uint32_t approx_bit;  // Torus representation bit size
 
     portablelvl2param()
@@ -80,7 +82,7 @@ struct portablelvl2param {
           l(lvl2param::l),
           Bgbit(lvl2param::Bgbit),
           Bg(lvl2param::Bg),
-          //   alpha(lvl2param::alpha),
+          alpha(lvl2param::alpha),
           approx_bit(std::numeric_limits<typename lvl2param::T>::digits)
     {
     }
@@ -94,8 +96,8 @@ struct portablelvl2param {
     bool operator==(const portablelvl2param& in) const
     {
         return (nbit == in.nbit) && (n == in.n) && (l == in.l) &&
-               (Bgbit == in.Bgbit) && (Bg == in.Bg)  //&& (alpha == in.alpha)
-               && (approx_bit == in.approx_bit);
+               (Bgbit == in.Bgbit) && (Bg == in.Bg) && (alpha == in.alpha) &&
+               (approx_bit == in.approx_bit);
     };
 };
 
@@ -154,8 +156,14 @@ struct portablelvl21param {
     std::uint32_t t;  // number of addition in keyswitching
     std::uint32_t
         basebit;  // how many bit should be encrypted in keyswitching key
+    double alpha;  // key noise, not serialized
 
-    portablelvl21param() : t(lvl21param::t), basebit(lvl21param::basebit) {}
+    portablelvl21param()
+        : t(lvl21param::t),
+          basebit(lvl21param::basebit),
+          alpha(lvl21param::alpha)
+    {
+    }
 
     template <class Archive>
     void serialize(Archive& archive)
@@ -165,7 +173,7 @@ struct portablelvl21param {
 
     bool operator==(const portablelvl21param& in) const
     {
-        return (t == in.t) && (basebit == in.basebit);
+        return (t == in.t) && (basebit == in.basebit) && (alpha == in.alpha);
     }
 };
 
@@ -173,17 +181,18 @@ struct portablelvl22param {
     std::uint32_t t;  // number of addition in keyswitching
     std::uint32_t
         basebit;  // how many bit should be encrypted in keyswitching key
-    // double alpha;     // key noise
+    double alpha;  // key noise, not serialized
 
     portablelvl22param()
         : t(lvl22param::t),
-          basebit(lvl22param::basebit)  //, alpha(lvl22param::targetP::alpha)
+          basebit(lvl22param::basebit),
+          alpha(lvl22param::alpha)
     {
     }
 
     bool operator==(const portablelvl22param& in) const
     {
-        return (t == in.t) && (basebit == in.basebit);  // && (alpha == in.alpha);
+        return (t == in.t) && (basebit == in.basebit) && (alpha == in.alpha);
     }
 };
 
@@ -198,16 +207,71 @@ struct lweParams {
 
     lweParams() : lvl0(), lvl1(), lvl2(), lvl10(), lvl20(), lvl21(), lvl22() {}
 
+    // The alphas of lvl2, lvl21 and lvl22 are not archived, so archives of
+    // earlier builds still load.
     template <class Archive>
     void serialize(Archive& archive)
     {
-        archive(lvl0.n, lvl0.alpha, lvl0.approx_bit, lvl1.nbit, lvl1.n, lvl1.l,
+        archive(lvl0.n);
+        serializeafterlvl0n(archive);
+    }
+    // The fields after lvl0.n. EvalKey loads them alone when it has already
+    // read lvl0.n in place of its class version.
+    template <class Archive>
+    void serializeafterlvl0n(Archive& archive)
+    {
+        archive(lvl0.alpha, lvl0.approx_bit, lvl1.nbit, lvl1.n, lvl1.l,
                 lvl1.Bgbit, lvl1.alpha, lvl1.approx_bit, lvl2.nbit, lvl2.n, lvl2.l,
                 lvl2.Bgbit, /*lvl2.alpha,*/ lvl2.approx_bit, lvl10.t, lvl10.basebit,
                 lvl10.alpha, lvl20.t, lvl20.basebit, lvl20.alpha, lvl21.t,
                 lvl21.basebit, lvl22.t, lvl22.basebit /*lvl22.alpha*/);
     }
 
+    // FNV-1a hash of every field, including those serialize leaves out. Files
+    // holding keys store it to reject keys made for other parameters.
+    uint64_t fingerprint() const
+    {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        const auto absorb = [&hash](const auto field) {
+            unsigned char bytes[sizeof(field)];
+            std::memcpy(bytes, &field, sizeof(field));
+            for (const unsigned char byte : bytes) {
+                hash ^= byte;
+                hash *= 0x100000001b3ULL;
+            }
+        };
+        absorb(lvl0.n);
+        absorb(lvl0.alpha);
+        absorb(lvl0.approx_bit);
+        absorb(lvl1.nbit);
+        absorb(lvl1.n);
+        absorb(lvl1.l);
+        absorb(lvl1.Bgbit);
+        absorb(lvl1.Bg);
+        absorb(lvl1.alpha);
+        absorb(lvl1.approx_bit);
+        absorb(lvl2.nbit);
+        absorb(lvl2.n);
+        absorb(lvl2.l);
+        absorb(lvl2.Bgbit);
+        absorb(lvl2.Bg);
+        absorb(lvl2.alpha);
+        absorb(lvl2.approx_bit);
+        absorb(lvl10.t);
+        absorb(lvl10.basebit);
+        absorb(lvl10.alpha);
+        absorb(lvl20.t);
+        absorb(lvl20.basebit);
+        absorb(lvl20.alpha);
+        absorb(lvl21.t);
+        absorb(lvl21.basebit);
+        absorb(lvl21.alpha);
+        absorb(lvl22.t);
+        absorb(lvl22.basebit);
+        absorb(lvl22.alpha);
+        return hash;
+    }
+
     // https://cpprefjp.github.io/lang/cpp20/consistent_comparison.html
     bool operator==(const lweParams& in) const
     {
@@ -6,22 +6,54 @@
 
 namespace TFHEpp {
 
+// Per-thread work counters of the blind rotation. Reset them before and read
+// them after a bootstrapping to see the work actually done for it.
+struct BlindRotateStats {
+    uint64_t cmux_executed = 0;
+    uint64_t cmux_skipped = 0;
+    // Transforms done inside a blind rotation only, not by key generation or
+    // external products elsewhere.
+    uint64_t fft = 0;
+    uint64_t ifft = 0;
+};
+
+inline thread_local BlindRotateStats blindrotatestats;
+// Number of blind rotations the thread is inside of.
+inline thread_local int blindrotatedepth = 0;
+
+inline void resetblindrotatestats() { blindrotatestats = {}; }
+
+// Marks the blind rotation whose transforms blindrotatestats counts.
+struct BlindRotateScope {
+    BlindRotateScope() { blindrotatedepth++; }
+    ~BlindRotateScope() { blindrotatedepth--; }
+    BlindRotateScope(const BlindRotateScope &) = delete;
+    BlindRotateScope &operator=(const BlindRotateScope &) = delete;
+};
+
+// Only the first active polynomials of the batch are transformed.
 template <class P, int batch>
-inline void TwistFFTbatch(Polynomialn<P, batch> &res, const PolynomialInFDn<P, batch> &a)
+inline void TwistFFTbatch(Polynomialn<P, batch> &res,
+                          const PolynomialInFDn<P, batch> &a,
+                          const int active = batch)
 {
     //std::cout << "b";
+    if (blindrotatedepth > 0) blindrotatestats.fft += active;
     if constexpr (std::is_same_v<P, lvl1param>)
-        TwistFpgaFFTbatch(res[0].data(), a[0].data(), batch);
+        TwistFpgaFFTbatch(res[0].data(), a[0].data(), active);
     else
         static_assert(false_v<typename P::T>, "Undefined TwistFFT batch!");
 }
 
 template <class P, int batch>
-inline void TwistIFFTbatch(PolynomialInFDn<P, batch> &res, const Polynomialn<P, batch> &a)
+inline void TwistIFFTbatch(PolynomialInFDn<P, batch> &res,
+                           const Polynomialn<P, batch> &a,
+                           const int active = batch)
 {
     //std::cout << "B";
+    if (blindrotatedepth > 0) blindrotatestats.ifft += active;
     if constexpr (std::is_same_v<P, lvl1param>)
-        TwistFpgaIFFTbatch(res[0].data(), a[0].data(), batch);
+        TwistFpgaIFFTbatch(res[0].data(), a[0].data(), active);
     else
         static_assert(false_v<typename P::T>, "Undefined TwistIFFT batch!");
 }
@@ -30,6 +62,7 @@ template <class P>
 inline void TwistFFT(Polynomial<P> &res, const PolynomialInFD<P> &a)
 {
     //std::cout << "*";
+    if (blindrotatedepth > 0) blindrotatestats.fft++;
     if constexpr (std::is_same_v<P, lvl1param>)
         TwistFpgaFFT<P::n>(res, a);
     else if constexpr (std::is_same_v<typename P::T, uint64_t>)
@@ -43,6 +76,7 @@ template <class P>
 inline void TwistFFTrescale(Polynomial<P> &res, const PolynomialInFD<P> &a)
 {
     //std::cout << "&";
+    if (blindrotatedepth > 0) blindrotatestats.fft++;
     if constexpr (std::is_same_v<P, lvl1param>)
         TwistFpgaFFTrescale<P>(res, a);
     else if constexpr (std::is_same_v<P, lvl2param>)
@@ -55,6 +89,7 @@ template <class P>
 inline void TwistIFFT(PolynomialInFD<P> &res, const Polynomial<P> &a)
 {
     //std::cout << "%";
+    if (blindrotatedepth > 0) blindrotatestats.ifft++;
     if constexpr (std::is_same_v<P, lvl1param>)
         TwistFpgaIFFT<P::n>(res, a);
     else if constexpr (std::is_same_v<typename P::T, uint64_t>)
@@ -107,9 +142,9 @@ inline void MulInFDbatch(PolynomialInFDn<P, batch> &res, const PolynomialInFDn<P
 
 template <class P, int batch>
 inline void MulInFDbatch(PolynomialInFDn<P, batch> &res, const PolynomialInFDn<P, batch> &a,
-                         const PolynomialInFD<P> &b)
+                         const PolynomialInFD<P> &b, const int active = batch)
 {
-    for (int i=0; i< batch; i++) {
+    for (int i=0; i< active; i++) {
         MulInFD<P::n>(res[i], a[i], b);
     }
 }
@@ -142,9 +177,9 @@ inline void FMAInFDbatch(PolynomialInFDn<P, batch> &res, const PolynomialInFDn<P
 
 template <class P, int batch>
 inline void FMAInFDbatch(PolynomialInFDn<P, batch> &res, const PolynomialInFDn<P, batch> &a,
-                         const PolynomialInFD<P> &b)
+                         const PolynomialInFD<P> &b, const int active = batch)
 {
-    for (int j=0; j< batch; j++) {
+    for (int j=0; j< active; j++) {
         FMAInFD<P::n>(res[j], a[j], b);
     }
 }
@@ -242,7 +277,6 @@ inline void PolyMulRescaleUnsigned(Polynomial<P> &res,
                                    const UnsignedPolynomial<P> &a,
                                    const UnsignedPolynomial<P> &b)
 {
-    std::cout << "d";
     PolynomialInFD<P> ffta, fftb;
     TwistIFFT<P>(ffta, a);
     TwistIFFT<P>(fftb, b);
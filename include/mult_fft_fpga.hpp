@@ -98,11 +98,18 @@ inline void TwistFpgaIFFT(std::array<double, N> &res, const std::array<uint32_t,
     fftplvl1.execute_reverse_torus32(res.data(), a.data());
 }
 
+// Without the FPGA the batch is transformed polynomial by polynomial.
 inline void TwistFpgaFFTbatch(uint32_t *a, const double *res, unsigned batch)
 {
+    for (unsigned j = 0; j < batch; j++)
+        fftplvl1.execute_direct_torus32(a + j * TFHEpp::lvl1param::n,
+                                        res + j * TFHEpp::lvl1param::n);
 }
 inline void TwistFpgaIFFTbatch(double *res, const uint32_t *a, unsigned batch)
 {
+    for (unsigned j = 0; j < batch; j++)
+        fftplvl1.execute_reverse_torus32(res + j * TFHEpp::lvl1param::n,
+                                         a + j * TFHEpp::lvl1param::n);
 }
 
 namespace TFHEpp {
@@ -9,6 +9,10 @@ template <class T, size_t N>
 struct alignas(64) aligned_array : public std::array<T, N> {};
 
 enum class ErrorDistribution { ModularGaussian, CenteredBinomial };
+
+// 256-bit seed from which the masks of seeded ciphertexts and keys are
+// expanded.
+using Seed = std::array<uint32_t, 8>;
 #include "params/128bit.hpp"
 struct lvl01param {
     using domainP = lvl0param;
@@ -34,9 +38,82 @@ struct lvlh2param {
     static constexpr uint32_t Addends = 1;
 };
 
+// Unrolled (multi-bit) blind rotation: Addends secret-key coefficients are
+// consumed per external product, at the cost of a larger bootstrapping key.
+struct lvl01Addends2param {
+    using domainP = lvl0param;
+    using targetP = lvl1param;
+    static constexpr uint32_t Addends = 2;
+};
+
+struct lvl01Addends3param {
+    using domainP = lvl0param;
+    using targetP = lvl1param;
+    static constexpr uint32_t Addends = 3;
+};
+
+struct lvl02Addends2param {
+    using domainP = lvl0param;
+    using targetP = lvl2param;
+    static constexpr uint32_t Addends = 2;
+};
+
+// Number of TRGSWs in one BootstrappingKeyElement. Each element covers
+// Addends coefficients of the domain key and holds one TRGSW per non-zero
+// assignment of those coefficients.
+template <class P>
+constexpr uint32_t bkelemnum()
+{
+    uint32_t num = 1;
+    for (uint32_t i = 0; i < P::Addends; i++)
+        num *= P::domainP::key_value_diff + 1;
+    return num - 1;
+}
+
+// Key assignments corresponding to each TRGSW of a BootstrappingKeyElement,
+// in the order they are stored.
+template <class P>
+constexpr std::array<std::array<int32_t, P::Addends>, bkelemnum<P>()>
+bkpatterngen()
+{
+    std::array<std::array<int32_t, P::Addends>, bkelemnum<P>()> patterns{};
+    std::array<int32_t, P::Addends> digits{};
+    for (int32_t &digit : digits) digit = P::domainP::key_value_min;
+    uint32_t count = 0;
+    for (uint32_t pattern = 0; pattern <= bkelemnum<P>(); pattern++) {
+        bool iszero = true;
+        for (const int32_t digit : digits) iszero &= digit == 0;
+        if (!iszero) patterns[count++] = digits;
+        for (int t = P::Addends - 1; t >= 0; t--) {
+            if (digits[t] < P::domainP::key_value_max) {
+                digits[t]++;
+                break;
+            }
+            digits[t] = P::domainP::key_value_min;
+        }
+    }
+    return patterns;
+}
+
 template <class P>
 using Key = std::array<typename P::T, P::k * P::n>;
 
+// Key with 1 bit per coefficient for binary keys and 2 for ternary ones. Bit i
+// of mag is set where the i-th coefficient is nonzero and bit i of sign where
+// it is -1.
+template <class P>
+struct PackedKey {
+    static constexpr uint32_t words = (P::k * P::n + 63) / 64;
+    std::array<uint64_t, words> mag;
+    std::array<uint64_t, P::key_value_min < 0 ? words : 0> sign;
+
+    template <class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(mag, sign);
+    }
+};
+
 template <class P>
 using TLWE = std::array<typename P::T, P::k * P::n + 1>;
 
@@ -99,19 +176,47 @@ using TRGSWFFTn = aligned_array<TRLWEInFDn<P, batch>, (P::k + 1) * P::l>;
 
 template <class P>
 using BootstrappingKeyElement =
-    std::array<TRGSW<typename P::targetP>, P::domainP::key_value_diff>;
+    std::array<TRGSW<typename P::targetP>, bkelemnum<P>()>;
 template <class P>
 using BootstrappingKeyElementFFT =
-    std::array<TRGSWFFT<typename P::targetP>, P::domainP::key_value_diff>;
+    std::array<TRGSWFFT<typename P::targetP>, bkelemnum<P>()>;
 
 
 template <class P>
 using BootstrappingKey =
-    std::array<BootstrappingKeyElement<P>, P::domainP::k * P::domainP::n>;
+    std::array<BootstrappingKeyElement<P>,
+               P::domainP::k * P::domainP::n / P::Addends>;
 template <class P>
 using BootstrappingKeyFFT =
     std::array<BootstrappingKeyElementFFT<P>,
                P::domainP::k * P::domainP::n / P::Addends>;
+// TRGSW with pseudorandom masks, stored as the bodies of its rows. The
+// masks are expanded from the seed of the key holding it.
+template <class P>
+using SeededTRGSW = std::array<Polynomial<P>, (P::k + 1) * P::l>;
+// BootstrappingKey with pseudorandom masks. b[i][count][r] is the body of row
+// r of bk[i][count], whose mask is the seededbkindex<P>(i, count, r)-th mask of
+// seed. It is about 1 / (k + 1) of the size of the BootstrappingKey.
+template <class P>
+struct SeededBootstrappingKey {
+    Seed seed;
+    std::array<std::array<SeededTRGSW<typename P::targetP>, bkelemnum<P>()>,
+               P::domainP::k * P::domainP::n / P::Addends>
+        b;
+
+    template <class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(seed, b);
+    }
+};
+template <class P>
+constexpr uint64_t seededbkindex(const int i, const int count, const int r)
+{
+    return (static_cast<uint64_t>(i) * bkelemnum<P>() + count) *
+               ((P::targetP::k + 1) * P::targetP::l) +
+           r;
+}
 
 
 template <class P>
@@ -119,6 +224,83 @@ using KeySwitchingKey = std::array<
     std::array<std::array<TLWE<typename P::targetP>, (1 << P::basebit) - 1>,
                P::t>,
     P::domainP::k * P::domainP::n>;
+// Row of a PackedKeySwitchingKey: a TLWE padded to a whole number of 64-byte
+// cache lines, so that every row starts on a cache line.
+template <class P>
+constexpr uint32_t packedksrowlen()
+{
+    constexpr uint32_t lanes = 64 / sizeof(typename P::targetP::T);
+    return (P::targetP::k * P::targetP::n + 1 + lanes - 1) / lanes * lanes;
+}
+template <class P>
+using PackedKeySwitchingKeyRow =
+    aligned_array<typename P::targetP::T, packedksrowlen<P>()>;
+template <class P>
+using PackedKeySwitchingKey = std::array<
+    std::array<std::array<PackedKeySwitchingKeyRow<P>, (1 << P::basebit) - 1>,
+               P::t>,
+    P::domainP::k * P::domainP::n>;
+// Rotation amounts of a blind rotation: the modulus switched mask
+// coefficients followed by bLong, the rotation of the test vector by the
+// body. They are below 2N, so 16 bits suffice.
+template <class P>
+using RotationIndices = aligned_array<uint16_t, P::domainP::k * P::domainP::n + 1>;
+// Row of a QuantizedKeySwitchingKey: the top bits bits of every coefficient
+// of a TLWE, split into planes of 16, 8 and 4 bits from the most significant
+// down. Each plane is a contiguous array, so widening a row is a few shifted
+// zero-extending loads that vectorize. The 4-bit plane holds coefficient l in
+// the low nibble of lo[l] and coefficient l + half in the high nibble.
+template <class P, uint32_t bits>
+struct QuantizedKeySwitchingKeyRow {
+    static constexpr uint32_t digits =
+        std::numeric_limits<typename P::targetP::T>::digits;
+    static_assert(bits % 4 == 0 && bits < digits && bits <= 28,
+                  "Unsupported quantization precision!");
+    static constexpr uint32_t len = P::targetP::k * P::targetP::n + 1;
+    static constexpr uint32_t half = (len + 1) / 2;
+    static constexpr uint32_t hibits = bits >= 16 ? 16 : 0;
+    static constexpr uint32_t midbits = (bits - hibits) >= 8 ? 8 : 0;
+    static constexpr uint32_t lobits = bits - hibits - midbits;
+    alignas(64) std::array<uint16_t, hibits ? len : 0> hi;
+    std::array<uint8_t, midbits ? len : 0> mid;
+    std::array<uint8_t, lobits ? half : 0> lo;
+
+    template <class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(hi, mid, lo);
+    }
+};
+template <class P, uint32_t bits = P::quantizedbits>
+using QuantizedKeySwitchingKey = std::array<
+    std::array<
+        std::array<QuantizedKeySwitchingKeyRow<P, bits>, (1 << P::basebit) - 1>,
+        P::t>,
+    P::domainP::k * P::domainP::n>;
+// KeySwitchingKey with pseudorandom masks, stored as the bodies of its
+// ciphertexts plus the seed the masks are expanded from. The mask of
+// b[i][j][k] is the ((i * t + j) * ((1 << basebit) - 1) + k)-th mask of seed.
+template <class P>
+struct SeededKeySwitchingKey {
+    Seed seed;
+    std::array<
+        std::array<std::array<typename P::targetP::T, (1 << P::basebit) - 1>,
+                   P::t>,
+        P::domainP::k * P::domainP::n>
+        b;
+
+    template <class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(seed, b);
+    }
+};
+template <class P>
+constexpr uint64_t seededksindex(const int i, const int j, const int k)
+{
+    return (static_cast<uint64_t>(i) * P::t + j) * ((1 << P::basebit) - 1) +
+           k;
+}
 template <class P>
 using SubsetKeySwitchingKey = std::array<
     std::array<std::array<TLWE<typename P::targetP>, (1 << P::basebit) - 1>,
@@ -158,6 +340,10 @@ using relinKeyFFT = std::array<TRLWEInFD<P>, P::l>;
 #define TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(fun) \
     fun(lvl01param);                                    \
     fun(lvl02param);
+#define TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE_ADDENDS(fun) \
+    fun(lvl01Addends2param);                                    \
+    fun(lvl01Addends3param);                                    \
+    fun(lvl02Addends2param);
 #define TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(fun) \
     fun(lvl10param);                                          \
     fun(lvl1hparam);                                          \
@@ -175,6 +361,8 @@ using relinKeyFFT = std::array<TRLWEInFD<P>, P::l>;
     fun(lvl10param, lvl01param, lvl1param::mu, otherparam::batch);
 #define TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(fun) \
     fun(lvl10param, lvl01param, lvl1param::mu);
+#define TFHEPP_EXPLICIT_INSTANTIATION_GATE_BATCH_BRIKS(fun) \
+    fun(lvl01param, lvl1param::mu, lvl10param, otherparam::batch);
 #define TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(fun) \
     fun(lvl01param, lvl1param::mu, lvl10param);
 #define TFHEPP_EXPLICIT_INSTANTIATION_GATE(fun) \
@@ -158,6 +158,8 @@ struct lvl21param {
     static constexpr ErrorDistribution errordist =
         ErrorDistribution::ModularGaussian;
     static const inline double alpha = lvl1param::alpha;  // key noise
+    static constexpr std::uint32_t quantizedbits =
+        28;  // bits kept per coefficient by QuantizedKeySwitchingKey
     using domainP = lvl2param;
     using targetP = lvl1param;
 };
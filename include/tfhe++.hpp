@@ -3,6 +3,9 @@
 #include "cloudkey.hpp"
 #include "cmuxmem.hpp"
 #include "detwfa.hpp"
+#include "evalkeyfile.hpp"
+#include "evalkeyregistry.hpp"
+#include "keygenjob.hpp"
 #include "externs/cloudkey.hpp"
 #include "externs/detwfa.hpp"
 #include "externs/keyswitch.hpp"
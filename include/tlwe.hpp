@@ -68,6 +68,72 @@ TLWE<P> tlweSymEncrypt(const typename P::T p, const Key<P> &key)
         return tlweSymEncrypt<P>(p, P::eta, key);
 }
 
+// Lane selectors of the 8 coefficients of a key byte: all ones where the bit
+// is set.
+template <class T>
+constexpr std::array<std::array<T, 8>, 256> bytelanesgen()
+{
+    std::array<std::array<T, 8>, 256> lanes{};
+    for (int v = 0; v < 256; v++)
+        for (int b = 0; b < 8; b++) lanes[v][b] = -static_cast<T>((v >> b) & 1);
+    return lanes;
+}
+template <class T>
+inline constexpr std::array<std::array<T, 8>, 256> bytelanes =
+    bytelanesgen<T>();
+
+// Inner product of the mask of c with a packed key. Every coefficient is
+// selected by a masked add, negated for the -1s of a ternary key, so no
+// multiplication is needed. The selectors of 8 coefficients at a time come
+// from bytelanes, so the adds run over whole vectors.
+template <class P>
+typename P::T tlweMaskKeyProduct(const TLWE<P> &c, const PackedKey<P> &key)
+{
+    using T = typename P::T;
+    constexpr int len = P::k * P::n;
+    T res = 0;
+    for (int i = 0; i < len; i += 8) {
+        const std::array<T, 8> &m =
+            bytelanes<T>[(key.mag[i / 64] >> (i % 64)) & 0xff];
+        const int lanes = std::min(8, len - i);
+        if constexpr (P::key_value_min < 0) {
+            const std::array<T, 8> &s =
+                bytelanes<T>[(key.sign[i / 64] >> (i % 64)) & 0xff];
+            for (int b = 0; b < lanes; b++)
+                res += ((c[i + b] ^ s[b]) - s[b]) & m[b];
+        }
+        else
+            for (int b = 0; b < lanes; b++) res += c[i + b] & m[b];
+    }
+    return res;
+}
+
+// tlweSymEncrypt under a packed key. The randomness is drawn as by
+// tlweSymEncrypt, so both give the same ciphertext for the same generator
+// state.
+template <class P>
+TLWE<P> tlweSymEncrypt(const typename P::T p, const PackedKey<P> &key)
+{
+    TLWE<P> res;
+    if constexpr (P::errordist == ErrorDistribution::ModularGaussian) {
+        std::uniform_int_distribution<typename P::T> Torusdist(
+            0, std::numeric_limits<typename P::T>::max());
+        res[P::k * P::n] = ModularGaussian<P>(p, P::alpha);
+        for (int i = 0; i < P::k * P::n; i++) res[i] = Torusdist(generator);
+    }
+    else {
+        std::uniform_int_distribution<typename P::T> Torusdist(0, P::q - 1);
+        res[P::k * P::n] =
+            p + CenteredBinomial<P>(P::eta)
+            << (std::numeric_limits<typename P::T>::digits - P::qbit);
+        for (int i = 0; i < P::k * P::n; i++)
+            res[i] = Torusdist(generator)
+                     << (std::numeric_limits<typename P::T>::digits - P::qbit);
+    }
+    res[P::k * P::n] += tlweMaskKeyProduct<P>(res, key);
+    return res;
+}
+
 template <class P>
 TLWE<P> tlweSymIntEncrypt(const typename P::T p, const double alpha,
                           const Key<P> &key)
@@ -91,6 +157,48 @@ TLWE<P> tlweSymIntEncrypt(const typename P::T p, const Key<P> &key)
         return tlweSymIntEncrypt<P>(p, P::eta, key);
 }
 
+// Fills the mask of c with the index-th pseudorandom mask of seed. The raw
+// 64-bit outputs of the PRNG are sliced into coefficients, so the expansion
+// does not depend on the standard library's distributions.
+template <class P>
+void tlweSeededMask(TLWE<P> &c, const Seed &seed, const uint64_t index)
+{
+    constexpr int digits = std::numeric_limits<typename P::T>::digits;
+    constexpr int slices = 64 / digits;
+    SeedExpander prng = seedexpander(seed, index);
+    uint64_t word = 0;
+    for (int i = 0; i < P::k * P::n; i++) {
+        if (i % slices == 0)
+            word = prng();
+        else
+            word >>= digits % 64;
+        const typename P::T a = static_cast<typename P::T>(word);
+        if constexpr (P::errordist == ErrorDistribution::ModularGaussian)
+            c[i] = a;
+        else
+            c[i] = a >> (digits - P::qbit) << (digits - P::qbit);
+    }
+}
+
+// tlweSymEncrypt with the mask expanded from (seed, index) instead of drawn
+// from the generator. Only the body has to be stored, as the mask can be
+// regenerated by tlweSeededMask.
+template <class P>
+TLWE<P> tlweSymEncryptSeeded(const typename P::T p, const Key<P> &key,
+                             const Seed &seed, const uint64_t index)
+{
+    TLWE<P> res;
+    tlweSeededMask<P>(res, seed, index);
+    if constexpr (P::errordist == ErrorDistribution::ModularGaussian)
+        res[P::k * P::n] = ModularGaussian<P>(p, P::alpha);
+    else
+        res[P::k * P::n] =
+            p + CenteredBinomial<P>(P::eta)
+            << (std::numeric_limits<typename P::T>::digits - P::qbit);
+    for (int i = 0; i < P::k * P::n; i++) res[P::k * P::n] += res[i] * key[i];
+    return res;
+}
+
 template <class P>
 typename P::T tlweSymPhase(const TLWE<P> &c, const Key<P> &key)
 {
@@ -101,6 +209,12 @@ typename P::T tlweSymPhase(const TLWE<P> &c, const Key<P> &key)
             phase -= c[k * P::n + i] * key[k * P::n + i];
     return phase;
 }
+template <class P>
+typename P::T tlweSymPhase(const TLWE<P> &c, const PackedKey<P> &key)
+{
+    return c[P::k * P::n] - tlweMaskKeyProduct<P>(c, key);
+}
+
 template <class P>
 bool decryptBit(typename P::T phase) {
     uint64_t message = phase/static_cast<typename P::T>(P::mu);
@@ -124,6 +238,12 @@ bool tlweSymDecrypt(const TLWE<P> &c, const Key<P> &key)
     return decryptBit<P>(phase);
 }
 
+template <class P>
+bool tlweSymDecrypt(const TLWE<P> &c, const PackedKey<P> &key)
+{
+    return decryptBit<P>(tlweSymPhase<P>(c, key));
+}
+
 template <class P, const uint plain_modulus>
 typename P::T tlweSymIntDecrypt(const TLWE<P> &c, const Key<P> &key)
 {
@@ -152,7 +272,7 @@ std::vector<TLWE<P>> bootsSymEncrypt(const std::vector<uint8_t> &p,
                                      const Key<P> &key)
 {
     vector<TLWE<P>> c(p.size());
-#pragma omp parallel for
+    TFHEPP_OMP(parallel for)
     for (int i = 0; i < p.size(); i++)
         c[i] = tlweSymEncrypt<P>(encryptBit<P>(p[i]), key);
 
@@ -166,16 +286,37 @@ std::vector<TLWE<P>> bootsSymEncrypt(const std::vector<uint8_t> &p,
     return bootsSymEncrypt<P>(p, sk.key.get<P>());
 }
 
+template <class P>
+std::vector<TLWE<P>> bootsSymEncrypt(const std::vector<uint8_t> &p,
+                                     const PackedKey<P> &key)
+{
+    vector<TLWE<P>> c(p.size());
+    TFHEPP_OMP(parallel for)
+    for (int i = 0; i < p.size(); i++)
+        c[i] = tlweSymEncrypt<P>(encryptBit<P>(p[i]), key);
+    return c;
+}
+
 template <class P>
 std::vector<uint8_t> bootsSymDecrypt(const std::vector<TLWE<P>> &c,
                                      const Key<P> &key)
 {
     vector<uint8_t> p(c.size());
-#pragma omp parallel for
+    TFHEPP_OMP(parallel for)
     for (int i = 0; i < c.size(); i++) p[i] = tlweSymDecrypt<P>(c[i], key);
     return p;
 }
 
+template <class P>
+std::vector<uint8_t> bootsSymDecrypt(const std::vector<TLWE<P>> &c,
+                                     const PackedKey<P> &key)
+{
+    vector<uint8_t> p(c.size());
+    TFHEPP_OMP(parallel for)
+    for (int i = 0; i < p.size(); i++) p[i] = tlweSymDecrypt<P>(c[i], key);
+    return p;
+}
+
 template <class P = lvl1param>
 std::vector<uint8_t> bootsSymDecrypt(const std::vector<TLWE<P>> &c,
                                      const SecretKey &sk)
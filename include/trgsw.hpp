@@ -10,13 +10,18 @@
 namespace TFHEpp {
 
 template <class P>
-TRGSWFFT<P> ApplyFFT2trgsw(const TRGSW<P> &trgsw)
+void ApplyFFT2trgsw(TRGSWFFT<P> &trgswfft, const TRGSW<P> &trgsw)
 {
-    //std::cout << "a";
-    alignas(64) TRGSWFFT<P> trgswfft;
     for (int i = 0; i < (P::k + 1) * P::l; i++)
         for (int j = 0; j < (P::k + 1); j++)
             TwistIFFT<P>(trgswfft[i][j], trgsw[i][j]);
+}
+
+template <class P>
+TRGSWFFT<P> ApplyFFT2trgsw(const TRGSW<P> &trgsw)
+{
+    alignas(64) TRGSWFFT<P> trgswfft;
+    ApplyFFT2trgsw<P>(trgswfft, trgsw);
     return trgswfft;
 }
 
@@ -125,13 +130,115 @@ TRGSWn<P, batch> trgswSymEncryptbatch(const Polynomialn<P, batch> &p, const Key<
         return trgswSymEncryptbatch<P, batch>(p, P::eta, key);
 }
 
+// Encrypts p straight into trgswfft, one TRLWE at a time, so no TRGSW is
+// materialized. The TRLWEs are drawn in the order of trgswSymEncrypt, hence the
+// result equals ApplyFFT2trgsw(trgswSymEncrypt(p)) for the same randomness.
+template <class P>
+void trgswfftSymEncrypt(TRGSWFFT<P> &trgswfft, const Polynomial<P> &p,
+                        const double alpha, const Key<P> &key)
+{
+    constexpr std::array<typename P::T, P::l> h = hgen<P>();
+
+    for (int k = 0; k < P::k + 1; k++)
+        for (int i = 0; i < P::l; i++) {
+            alignas(64) TRLWE<P> trlwe = trlweSymEncryptZero<P>(alpha, key);
+            for (int j = 0; j < P::n; j++)
+                trlwe[k][j] += static_cast<typename P::T>(p[j]) * h[i];
+            for (int m = 0; m < P::k + 1; m++)
+                TwistIFFT<P>(trgswfft[i + k * P::l][m], trlwe[m]);
+        }
+}
+
+template <class P>
+void trgswfftSymEncrypt(TRGSWFFT<P> &trgswfft, const Polynomial<P> &p,
+                        const uint eta, const Key<P> &key)
+{
+    constexpr std::array<typename P::T, P::l> h = hgen<P>();
+
+    for (int k = 0; k < P::k + 1; k++)
+        for (int i = 0; i < P::l; i++) {
+            alignas(64) TRLWE<P> trlwe = trlweSymEncryptZero<P>(eta, key);
+            for (int j = 0; j < P::n; j++)
+                trlwe[k][j] += static_cast<typename P::T>(p[j]) * h[i];
+            for (int m = 0; m < P::k + 1; m++)
+                TwistIFFT<P>(trgswfft[i + k * P::l][m], trlwe[m]);
+        }
+}
+
+template <class P>
+void trgswfftSymEncrypt(TRGSWFFT<P> &trgswfft, const Polynomial<P> &p,
+                        const Key<P> &key)
+{
+    if constexpr (P::errordist == ErrorDistribution::ModularGaussian)
+        trgswfftSymEncrypt<P>(trgswfft, p, P::alpha, key);
+    else
+        trgswfftSymEncrypt<P>(trgswfft, p, P::eta, key);
+}
+
+// Encrypts p into a TRGSW whose row r has the (index + r)-th mask of seed, and
+// stores only the bodies. The rows which trgswSymEncrypt puts p * h[i] on the
+// mask of carry -p * key * h[i] in the body instead, which is the same
+// ciphertext up to a noiseless encryption of zero, so the masks stay purely
+// pseudorandom.
+template <class P>
+void trgswSymEncryptSeeded(SeededTRGSW<P> &res, const Polynomial<P> &p,
+                           const Key<P> &key, const Seed &seed,
+                           const uint64_t index)
+{
+    constexpr std::array<typename P::T, P::l> h = hgen<P>();
+
+    for (int k = 0; k < P::k + 1; k++)
+        for (int i = 0; i < P::l; i++) {
+            alignas(64) Polynomial<P> plain;
+            for (int j = 0; j < P::n; j++)
+                plain[j] = static_cast<typename P::T>(p[j]) * h[i];
+            if (k < P::k) {
+                // The torus operand goes first, as the FFT based PolyMul
+                // loses products of two small polynomials.
+                alignas(64) Polynomial<P> partkey, temp;
+                for (int j = 0; j < P::n; j++) partkey[j] = key[k * P::n + j];
+                PolyMul<P>(temp, plain, partkey);
+                for (int j = 0; j < P::n; j++) plain[j] = -temp[j];
+            }
+            alignas(64) TRLWE<P> trlwe;
+            trlweSymEncryptZeroSeeded<P>(trlwe, key, seed,
+                                         index + i + k * P::l);
+            for (int j = 0; j < P::n; j++)
+                res[i + k * P::l][j] = trlwe[P::k][j] + plain[j];
+        }
+}
+
+// Regenerates the masks of a SeededTRGSW encrypted with (seed, index).
+template <class P>
+void trgswSeededExpand(TRGSW<P> &trgsw, const SeededTRGSW<P> &seeded,
+                       const Seed &seed, const uint64_t index)
+{
+    for (int r = 0; r < (P::k + 1) * P::l; r++) {
+        trlweSeededMask<P>(trgsw[r], seed, index + r);
+        trgsw[r][P::k] = seeded[r];
+    }
+}
+
+// trgswSeededExpand straight into the Fourier domain.
+template <class P>
+void trgswfftSeededExpand(TRGSWFFT<P> &trgswfft, const SeededTRGSW<P> &seeded,
+                          const Seed &seed, const uint64_t index)
+{
+    for (int r = 0; r < (P::k + 1) * P::l; r++) {
+        alignas(64) TRLWE<P> trlwe;
+        trlweSeededMask<P>(trlwe, seed, index + r);
+        for (int m = 0; m < P::k; m++) TwistIFFT<P>(trgswfft[r][m], trlwe[m]);
+        TwistIFFT<P>(trgswfft[r][P::k], seeded[r]);
+    }
+}
+
 template <class P>
 TRGSWFFT<P> trgswfftSymEncrypt(const Polynomial<P> &p, const double alpha,
                                const Key<P> &key)
 {
-    //std::cout << "j";
-    TRGSW<P> trgsw = trgswSymEncrypt<P>(p, alpha, key);
-    return ApplyFFT2trgsw<P>(trgsw);
+    alignas(64) TRGSWFFT<P> trgswfft;
+    trgswfftSymEncrypt<P>(trgswfft, p, alpha, key);
+    return trgswfft;
 }
 
 template <class P, int batch>
@@ -146,9 +253,9 @@ template <class P>
 TRGSWFFT<P> trgswfftSymEncrypt(const Polynomial<P> &p, const uint eta,
                                const Key<P> &key)
 {
-    std::cout << "J";
-    TRGSW<P> trgsw = trgswSymEncrypt<P>(p, eta, key);
-    return ApplyFFT2trgsw<P>(trgsw);
+    alignas(64) TRGSWFFT<P> trgswfft;
+    trgswfftSymEncrypt<P>(trgswfft, p, eta, key);
+    return trgswfft;
 }
 
 template <class P, int batch>
@@ -121,6 +121,52 @@ TRLWE<P> trlweSymEncryptZero(const Key<P> &key)
         return trlweSymEncryptZero<P>(P::eta, key);
 }
 
+// Fills the mask of c with the index-th pseudorandom mask of seed, sliced from
+// the PRNG as in tlweSeededMask.
+template <class P>
+void trlweSeededMask(TRLWE<P> &c, const Seed &seed, const uint64_t index)
+{
+    constexpr int digits = std::numeric_limits<typename P::T>::digits;
+    constexpr int slices = 64 / digits;
+    SeedExpander prng = seedexpander(seed, index);
+    uint64_t word = 0;
+    for (int i = 0; i < P::k * P::n; i++) {
+        if (i % slices == 0)
+            word = prng();
+        else
+            word >>= digits % 64;
+        const typename P::T a = static_cast<typename P::T>(word);
+        if constexpr (P::errordist == ErrorDistribution::ModularGaussian)
+            c[i / P::n][i % P::n] = a;
+        else
+            c[i / P::n][i % P::n] = a >> (digits - P::qbit)
+                                    << (digits - P::qbit);
+    }
+}
+
+// trlweSymEncryptZero with the mask expanded from (seed, index) instead of
+// drawn from the generator, so only c[P::k] has to be stored.
+template <class P>
+void trlweSymEncryptZeroSeeded(TRLWE<P> &c, const Key<P> &key,
+                               const Seed &seed, const uint64_t index)
+{
+    trlweSeededMask<P>(c, seed, index);
+    for (typename P::T &i : c[P::k]) {
+        if constexpr (P::errordist == ErrorDistribution::ModularGaussian)
+            i = ModularGaussian<P>(0, P::alpha);
+        else
+            i = CenteredBinomial<P>(P::eta)
+                << (std::numeric_limits<typename P::T>::digits - P::qbit);
+    }
+    for (int k = 0; k < P::k; k++) {
+        alignas(64) Polynomial<P> partkey;
+        for (int i = 0; i < P::n; i++) partkey[i] = key[k * P::n + i];
+        alignas(64) Polynomial<P> temp;
+        PolyMul<P>(temp, c[k], partkey);
+        for (int i = 0; i < P::n; i++) c[P::k][i] += temp[i];
+    }
+}
+
 template <class P, int batch>
 TRLWEn<P,batch> trlweSymEncryptZerobatch(const Key<P> &key)
 {
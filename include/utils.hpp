@@ -1,8 +1,9 @@
 #pragma once
 
-#ifdef USE_RANDEN
-#include <randen.h>
+#ifndef USE_RANDEN
+#error "USE_RANDEN is required: keys are expanded from seeds by Randen"
 #endif
+#include <randen.h>
 
 #include <algorithm>
 #include <array>
@@ -10,16 +11,138 @@
 #include <cstdlib>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <random>
 
-namespace TFHEpp {
-#ifdef USE_RANDEN
-static thread_local std::random_device trng;
-static thread_local randen::Randen<uint64_t> generator(trng);
+#include "params.hpp"
+
+// Pragma of an OpenMP loop, e.g. TFHEPP_OMP(parallel for). The loops are
+// parallel in builds with -DUSE_OPENMP=ON; otherwise they run serially and
+// the pragma is left out rather than warned about as unknown.
+#ifdef _OPENMP
+#define TFHEPP_OMP_PRAGMA(...) _Pragma(#__VA_ARGS__)
+#define TFHEPP_OMP(...) TFHEPP_OMP_PRAGMA(omp __VA_ARGS__)
 #else
-static thread_local std::random_device generator;
+#define TFHEPP_OMP(...)
 #endif
 
+namespace TFHEpp {
+// PRNG expanding a Seed. Published masks are expanded from seeds, so this
+// must be a cryptographic PRNG whose outputs do not give its state away.
+using SeedExpander = randen::Randen<uint64_t>;
+
+// Source of the randomness of encryption. Every thread has its own,
+// seeded from the random device, which can be redirected to a SeedExpander by
+// a GeneratorSeed.
+class Generator {
+public:
+    using result_type = uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max()
+    {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()()
+    {
+        if (expander != nullptr) return (*expander)();
+        return engine();
+    }
+
+    SeedExpander *expander = nullptr;
+
+private:
+    std::random_device trng;
+    randen::Randen<uint64_t> engine{trng};
+};
+
+// inline so that all the translation units share the generators of a thread.
+// generator gives what is published, the masks of ciphertexts and the seeds
+// of seeded keys. noisegenerator gives what is secret, the noise and the
+// secret keys, so no published value is drawn from the stream of a secret.
+inline thread_local Generator generator;
+inline thread_local Generator noisegenerator;
+
+inline Seed seedgen()
+{
+    std::random_device rd;
+    Seed seed;
+    for (uint32_t &s : seed) s = rd();
+    return seed;
+}
+
+// The independent streams expanded from one seed and index.
+enum class SeedStream : uint32_t { mask, noise };
+
+// The SeedSequence Randen::reseed reads the words to absorb from.
+struct SeedExpanderKey {
+    using result_type = uint32_t;
+    std::array<uint32_t, std::tuple_size_v<Seed> + 3> words;
+    void generate(uint32_t *begin, uint32_t *end) const
+    {
+        std::fill(begin, end, 0);
+        std::copy(words.begin(), words.end(), begin);
+    }
+};
+
+// PRNG of the index-th mask, or noise, expanded from seed. seed, index and
+// stream key Randen directly: they are absorbed into its sponge as they are,
+// without going through std::seed_seq, so the expansion is as strong as the
+// Randen permutation.
+inline SeedExpander seedexpander(const Seed &seed, const uint64_t index,
+                                 const SeedStream stream = SeedStream::mask)
+{
+    SeedExpanderKey key;
+    std::copy(seed.begin(), seed.end(), key.words.begin());
+    key.words[seed.size()] = static_cast<uint32_t>(index);
+    key.words[seed.size() + 1] = static_cast<uint32_t>(index >> 32);
+    key.words[seed.size() + 2] = static_cast<uint32_t>(stream);
+    SeedExpander expander;
+    expander.reseed(key);
+    return expander;
+}
+
+// Makes generator and noisegenerator of this thread draw from the mask and
+// noise streams of (seed, index) until the object is destroyed. Key
+// generation opens one per row, so a row depends only on (seed, index) and
+// not on the thread or the order it was made in, and its published masks say
+// nothing about its noise.
+class GeneratorSeed {
+public:
+    GeneratorSeed(const Seed &seed, const uint64_t index)
+        : mask(seedexpander(seed, index, SeedStream::mask)),
+          noise(seedexpander(seed, index, SeedStream::noise)),
+          previousmask(generator.expander),
+          previousnoise(noisegenerator.expander)
+    {
+        generator.expander = &mask;
+        noisegenerator.expander = &noise;
+    }
+    ~GeneratorSeed()
+    {
+        generator.expander = previousmask;
+        noisegenerator.expander = previousnoise;
+    }
+    GeneratorSeed(const GeneratorSeed &) = delete;
+    GeneratorSeed &operator=(const GeneratorSeed &) = delete;
+
+private:
+    SeedExpander mask, noise;
+    SeedExpander *previousmask, *previousnoise;
+};
+
+// Seed of a key generation. The seeds keying the noise of the rows are drawn
+// from noisegenerator; published ones, such as the mask seed of a seeded key,
+// from generator. Either way a key generation run inside a GeneratorSeed is
+// reproducible.
+inline Seed keygenseedgen(Generator &source = noisegenerator)
+{
+    std::uniform_int_distribution<uint32_t> dist;
+    Seed seed;
+    for (uint32_t &s : seed) s = dist(source);
+    return seed;
+}
+
 // https://qiita.com/saka1_p/items/e8c4dfdbfa88449190c5
 template <typename T>
 constexpr bool false_v = false;
@@ -125,20 +248,20 @@ inline typename P::T ModularGaussian(typename P::T center, double stdev)
     if constexpr (std::is_same_v<typename P::T, uint16_t>) {
         // 16bit fixed-point number version
         std::normal_distribution<double> distribution(0., stdev);
-        double err = distribution(generator);
+        double err = distribution(noisegenerator);
         return center + dtot16(err);
     }
     else if constexpr (std::is_same_v<typename P::T, uint32_t>) {
         // 32bit fixed-point number version
         std::normal_distribution<double> distribution(0., stdev);
-        double err = distribution(generator);
+        double err = distribution(noisegenerator);
         return center + dtot32(err);
     }
     else if constexpr (std::is_same_v<typename P::T, uint64_t>) {
         // 64bit fixed-point number version
         static const double _2p64 = std::pow(2., 64);
         std::normal_distribution<double> distribution(0., 1.0);
-        const double val = stdev * distribution(generator) * _2p64;
+        const double val = stdev * distribution(noisegenerator) * _2p64;
         const uint64_t ival = static_cast<typename P::T>(val);
         return ival + center;
     }
@@ -149,18 +272,14 @@ inline typename P::T ModularGaussian(typename P::T center, double stdev)
 template <class P>
 inline typename P::T CenteredBinomial(uint eta)
 {
-    static uint64_t buf;
-    static uint_fast8_t count = 64;
+    uint64_t buf = 0;
     typename P::T acc = 0;
     std::uniform_int_distribution<uint64_t> dist(
         0, std::numeric_limits<uint64_t>::max());
     for (int i = 0; i < 2 * eta; i++) {
-        if (count >= 64) {
-            buf = dist(generator);
-        }
+        if (i % 64 == 0) buf = dist(noisegenerator);
         acc += buf & 1;
         buf >>= 1;
-        count++;
     }
     return acc - eta;
 }
@@ -230,4 +349,125 @@ inline void Automorphism(Polynomial<P> &res, const Polynomial<P> &poly,
     }
 }
 
+// Signed permutation of τ_d for odd d. Entry i is i * d mod 2N: its low nbit
+// bits are the coefficient that coefficient i lands on and bit nbit tells
+// whether it is negated.
+template <class P>
+using AutomorphismTable = std::array<uint32_t, P::n>;
+
+template <class P>
+AutomorphismTable<P> automorphismtablegen(const uint d)
+{
+    constexpr uint32_t mask = (1ULL << (P::nbit + 1)) - 1;
+    AutomorphismTable<P> table;
+    for (uint i = 0; i < P::n; i++) table[i] = (i * d) & mask;
+    return table;
+}
+
+// τ_d is a bijection for odd d, so every coefficient of res is written once.
+template <class P>
+inline void Automorphism(Polynomial<P> &res, const Polynomial<P> &poly,
+                         const AutomorphismTable<P> &table)
+{
+    constexpr uint32_t Nmask = (1ULL << (P::nbit)) - 1;
+    constexpr uint32_t signmask = 1ULL << (P::nbit);
+    for (uint i = 0; i < P::n; i++) {
+        const uint32_t entry = table[i];
+        res[entry & Nmask] = (entry & signmask) ? -poly[i] : poly[i];
+    }
+}
+
+// τ_d in the layout of TwistIFFT. Slot k < N/2 holds the evaluation at
+// ω^(1-4k), ω = exp(iπ/N), with the real part at k and the imaginary part at
+// k + N/2. τ_d moves the evaluation at ω^(d(1-4k)) to slot k, which is another
+// slot or, for the exponents that are 3 mod 4, the conjugate of one. Entry k
+// is the source slot, with the top bit set when it is conjugated.
+template <class P>
+using AutomorphismInFDTable = std::array<uint32_t, P::n / 2>;
+constexpr uint32_t automorphisminfdconjmask = 1U << 31;
+
+template <class P>
+AutomorphismInFDTable<P> automorphisminfdtablegen(const uint d)
+{
+    constexpr int64_t twoN = 2 * P::n;
+    AutomorphismInFDTable<P> table;
+    for (int64_t k = 0; k < P::n / 2; k++) {
+        int64_t e = (static_cast<int64_t>(d) * (1 - 4 * k)) % twoN;
+        if (e < 0) e += twoN;
+        if ((e & 3) == 1)
+            table[k] = ((twoN + 1 - e) % twoN) / 4;
+        else
+            table[k] = ((1 + e) % twoN) / 4 | automorphisminfdconjmask;
+    }
+    return table;
+}
+
+template <class P>
+inline void AutomorphismInFD(PolynomialInFD<P> &res,
+                             const PolynomialInFD<P> &a,
+                             const AutomorphismInFDTable<P> &table)
+{
+    constexpr uint Ns2 = P::n / 2;
+    for (uint k = 0; k < Ns2; k++) {
+        const uint32_t entry = table[k];
+        const uint32_t src = entry & ~automorphisminfdconjmask;
+        res[k] = a[src];
+        res[k + Ns2] =
+            (entry & automorphisminfdconjmask) ? -a[src + Ns2] : a[src + Ns2];
+    }
+}
+
+// Tables of τ_(2^l+1), 1 <= l <= nbit, the automorphisms of the annihilation
+// key switch and of the packing key switch. They are built on first use.
+template <class P>
+struct AnnihilationTables {
+    std::array<AutomorphismTable<P>, P::nbit + 1> coef;
+    std::array<AutomorphismInFDTable<P>, P::nbit + 1> fd;
+};
+
+template <class P>
+const AnnihilationTables<P> &annihilationtables()
+{
+    static const std::unique_ptr<AnnihilationTables<P>> tables = [] {
+        auto t = std::make_unique<AnnihilationTables<P>>();
+        for (uint l = 1; l <= P::nbit; l++) {
+            t->coef[l] = automorphismtablegen<P>((1U << l) + 1);
+            t->fd[l] = automorphisminfdtablegen<P>((1U << l) + 1);
+        }
+        return t;
+    }();
+    return *tables;
+}
+
+// Returns l when d = 2^l + 1 has a cached table and 0 otherwise.
+template <class P>
+inline uint annihilationtableindex(const uint d)
+{
+    const uint dm1 = d - 1;
+    if (d < 3 || (dm1 & (dm1 - 1)) != 0) return 0;
+    const uint l = __builtin_ctz(dm1);
+    return l <= P::nbit ? l : 0;
+}
+
+// The cached table of τ_d if there is one, otherwise buf filled with it.
+template <class P>
+inline const AutomorphismTable<P> &automorphismtable(AutomorphismTable<P> &buf,
+                                                     const uint d)
+{
+    const uint l = annihilationtableindex<P>(d);
+    if (l != 0) return annihilationtables<P>().coef[l];
+    buf = automorphismtablegen<P>(d);
+    return buf;
+}
+
+template <class P>
+inline const AutomorphismInFDTable<P> &automorphisminfdtable(
+    AutomorphismInFDTable<P> &buf, const uint d)
+{
+    const uint l = annihilationtableindex<P>(d);
+    if (l != 0) return annihilationtables<P>().fd[l];
+    buf = automorphisminfdtablegen<P>(d);
+    return buf;
+}
+
 }  // namespace TFHEpp
@@ -4,12 +4,26 @@ namespace TFHEpp {
 #define INST(P) \
     template void bkgen<P>(BootstrappingKey<P> & bk, const SecretKey& sk)
 TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
+TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE_ADDENDS(INST)
 #undef INST
 
 #define INST(P)                                               \
     template void bkfftgen<P>(BootstrappingKeyFFT<P> & bkfft, \
                               const SecretKey& sk)
 TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
+TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE_ADDENDS(INST)
+#undef INST
+
+#define INST(P)                                                  \
+    template void seededbkgen<P>(SeededBootstrappingKey<P> & bk, \
+                                 const SecretKey& sk)
+TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
+#undef INST
+
+#define INST(P)                                                  \
+    template void bkfftexpand<P>(BootstrappingKeyFFT<P> & bkfft, \
+                                 const SeededBootstrappingKey<P>& seeded)
+TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
 #undef INST
 
 #define INST(P) \
@@ -17,6 +31,24 @@ TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
 #undef INST
 
+#define INST(P)                                                 \
+    template void seededikskgen<P>(SeededKeySwitchingKey<P> & ksk, \
+                                   const SecretKey& sk)
+TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
+#undef INST
+
+#define INST(P)                                          \
+    template void ikskexpand<P>(KeySwitchingKey<P> & ksk, \
+                                const SeededKeySwitchingKey<P>& seeded)
+TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
+#undef INST
+
+#define INST(P)                                               \
+    template void packedikskgen<P>(PackedKeySwitchingKey<P> & ksk, \
+                                   const SecretKey& sk)
+TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
+#undef INST
+
 #define INST(P)                                                 \
     template void subikskgen<P>(SubsetKeySwitchingKey<P> & ksk, \
                                 const SecretKey& sk)
@@ -43,16 +75,47 @@ TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
 
 #define INST(P) template void EvalKey::emplacebkfft<P>(const SecretKey& sk)
 TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
+TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE_ADDENDS(INST)
 #undef INST
 
 #define INST(P) template void EvalKey::emplacebk2bkfft<P>()
 TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
 #undef INST
 
+#define INST(P) template void EvalKey::emplaceseedbk<P>(const SecretKey& sk)
+TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
+#undef INST
+
+#define INST(P) template void EvalKey::emplaceseedbk2bkfft<P>()
+TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
+#undef INST
+
 #define INST(P) template void EvalKey::emplaceiksk<P>(const SecretKey& sk)
 TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
 #undef INST
 
+#define INST(P) template void EvalKey::emplaceahk<P>(const SecretKey& sk)
+TFHEPP_EXPLICIT_INSTANTIATION_TRLWE(INST)
+#undef INST
+
+#define INST(P) \
+    template void EvalKey::emplaceseediksk<P>(const SecretKey& sk)
+TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
+#undef INST
+
+#define INST(P) template void EvalKey::emplaceseediksk2iksk<P>()
+TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
+#undef INST
+
+#define INST(P) \
+    template void EvalKey::emplacepackediksk<P>(const SecretKey& sk)
+TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
+#undef INST
+
+#define INST(P) template void EvalKey::emplaceiksk2packediksk<P>()
+TFHEPP_EXPLICIT_INSTANTIATION_KEY_SWITCH_TO_TLWE(INST)
+#undef INST
+
 #define INST(P) template void EvalKey::emplacesubiksk<P>(const SecretKey& sk)
 TFHEPP_EXPLICIT_INSTANTIATION_SUBSET_KEY_SWITCH_TO_TLWE(INST)
 #undef INST
@@ -14,4 +14,12 @@ TFHEPP_EXPLICIT_INSTANTIATION_TRLWE(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
 #undef INST
 
+#define INST(bkP)                                             \
+    template void CMUXFFTwithPolynomialMulByXaiMinusOne<bkP>( \
+        TRLWE<typename bkP::targetP> & acc,                   \
+        const BootstrappingKeyElementFFT<bkP> &cs,            \
+        const std::array<int, bkP::Addends> &a)
+TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE_ADDENDS(INST)
+#undef INST
+
 }  // namespace TFHEpp
\ No newline at end of file
@@ -0,0 +1,365 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <evalkeyfile.hpp>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace TFHEpp {
+
+namespace {
+
+uint64_t alignsection(const uint64_t offset)
+{
+    return (offset + evalkeyfilealign - 1) / evalkeyfilealign *
+           evalkeyfilealign;
+}
+
+struct SectionWriter {
+    std::vector<EvalKeyFileSection> sections;
+    std::vector<const char*> data;
+
+    void add(const std::string& name, const void* key, const uint64_t size)
+    {
+        EvalKeyFileSection section = {};
+        if (name.size() >= section.name.size())
+            throw std::runtime_error("EvalKey file: section name too long: " +
+                                     name);
+        std::copy(name.begin(), name.end(), section.name.begin());
+        section.size = size;
+        sections.push_back(section);
+        data.push_back(static_cast<const char*>(key));
+    }
+
+    template <class T>
+    void operator()(const char* name, const std::shared_ptr<T>& key)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (key) add(name, key.get(), sizeof(T));
+    }
+
+    template <class T>
+    void operator()(
+        const char* name,
+        const std::unordered_map<std::string, std::shared_ptr<T>>& keys)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        std::vector<std::string> names;
+        for (const auto& [key, value] : keys)
+            if (value) names.push_back(key);
+        // The iteration order of unordered_map is unspecified.
+        std::sort(names.begin(), names.end());
+        for (const std::string& key : names)
+            add(std::string(name) + "/" + key, keys.at(key).get(), sizeof(T));
+    }
+};
+
+struct SectionMapper {
+    EvalKeyFile& file;
+
+    template <class T>
+    void operator()(const char* name, std::shared_ptr<T>& key)
+    {
+        if (file.contains(name))
+            key = std::static_pointer_cast<T>(file.load(name, sizeof(T)));
+    }
+
+    template <class T>
+    void operator()(const char* name,
+                    std::unordered_map<std::string, std::shared_ptr<T>>& keys)
+    {
+        const std::string prefix = std::string(name) + "/";
+        for (const std::string& sectionname : file.names())
+            if (sectionname.compare(0, prefix.size(), prefix) == 0)
+                keys[sectionname.substr(prefix.size())] =
+                    std::static_pointer_cast<T>(
+                        file.load(sectionname, sizeof(T)));
+    }
+};
+
+// Counts the keys of the file which have a member to go to.
+struct SectionCounter {
+    const EvalKeyFile& file;
+    uint64_t count = 0;
+
+    template <class T>
+    void operator()(const char* name, const std::shared_ptr<T>&)
+    {
+        count += file.contains(name);
+    }
+
+    template <class T>
+    void operator()(
+        const char* name,
+        const std::unordered_map<std::string, std::shared_ptr<T>>&)
+    {
+        const std::string prefix = std::string(name) + "/";
+        for (const std::string& sectionname : file.names())
+            count += sectionname.compare(0, prefix.size(), prefix) == 0;
+    }
+};
+
+// Throws if the file holds keys which no member of EvalKey can take.
+void checksections(const EvalKeyFile& file, const std::string& path)
+{
+    SectionCounter counter{file};
+    EvalKey().foreachkey(counter);
+    if (counter.count != file.names().size())
+        throw std::runtime_error("EvalKey file: unknown sections in " + path);
+}
+
+}  // namespace
+
+void writeevalkeyfile(const std::string& path, const EvalKey& ek)
+{
+    SectionWriter writer;
+    ek.foreachkey(writer);
+
+    EvalKeyFileHeader header = {};
+    header.magic = evalkeyfilemagic;
+    header.version = evalkeyfileversion;
+    header.byteorder = evalkeyfilebyteorder;
+    header.fingerprint = ek.params.fingerprint();
+    header.sectionnum = writer.sections.size();
+    uint64_t offset = sizeof(EvalKeyFileHeader) +
+                      writer.sections.size() * sizeof(EvalKeyFileSection);
+    for (EvalKeyFileSection& section : writer.sections) {
+        section.offset = alignsection(offset);
+        offset = section.offset + section.size;
+    }
+    header.filesize = offset;
+
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ofs.write(reinterpret_cast<const char*>(writer.sections.data()),
+              writer.sections.size() * sizeof(EvalKeyFileSection));
+    const std::array<char, evalkeyfilealign> padding = {};
+    for (size_t i = 0; i < writer.sections.size(); i++) {
+        const EvalKeyFileSection& section = writer.sections[i];
+        ofs.write(padding.data(),
+                  section.offset - static_cast<uint64_t>(ofs.tellp()));
+        ofs.write(writer.data[i], section.size);
+    }
+    if (!ofs) throw std::runtime_error("EvalKey file: cannot write " + path);
+}
+
+EvalKeyFile::EvalKeyFile(const std::string& path, const Mode mode)
+    : path(path), mode(mode)
+{
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("EvalKey file: cannot open " + path);
+    struct stat st;
+    EvalKeyFileHeader header;
+    if (fstat(fd, &st) != 0 ||
+        static_cast<uint64_t>(st.st_size) < sizeof(header) ||
+        pread(fd, &header, sizeof(header), 0) != sizeof(header)) {
+        close(fd);
+        throw std::runtime_error("EvalKey file: too short: " + path);
+    }
+    const uint64_t filesize = st.st_size;
+    const lweParams params;
+    std::string error;
+    if (header.magic != evalkeyfilemagic)
+        error = "not an EvalKey file";
+    else if (header.version != evalkeyfileversion)
+        error = "unsupported version " + std::to_string(header.version);
+    else if (header.byteorder != evalkeyfilebyteorder)
+        error = "wrong byte order";
+    else if (header.fingerprint != params.fingerprint())
+        error = "made for other parameters";
+    else if (header.filesize != filesize ||
+             header.sectionnum >
+                 (filesize - sizeof(header)) / sizeof(EvalKeyFileSection))
+        error = "truncated";
+    std::vector<EvalKeyFileSection> table(error.empty() ? header.sectionnum
+                                                        : 0);
+    const ssize_t tablesize = table.size() * sizeof(EvalKeyFileSection);
+    if (error.empty() &&
+        pread(fd, table.data(), tablesize, sizeof(header)) != tablesize)
+        error = "cannot read the section table";
+    // Keys start after the section table.
+    const uint64_t datastart = sizeof(header) + tablesize;
+    for (const EvalKeyFileSection& section : table) {
+        if (!error.empty()) break;
+        if (section.name.back() != '\0' ||
+            section.offset % evalkeyfilealign != 0 ||
+            section.offset < datastart || section.offset > filesize ||
+            section.size > filesize - section.offset)
+            error = "broken section table";
+        else
+            components.try_emplace(section.name.data(), section);
+    }
+    if (error.empty() && mode == Mode::map) {
+        // Mapping reserves address space only; pages are read on access. The
+        // mapping is private, so a page written through a key is copied
+        // instead of faulting, and the file is never changed.
+        void* addr = mmap(nullptr, filesize, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED)
+            error = "cannot map";
+        else
+            mapping = std::shared_ptr<void>(
+                addr, [filesize](void* p) { munmap(p, filesize); });
+    }
+    if (!error.empty()) {
+        close(fd);
+        throw std::runtime_error("EvalKey file: " + error + ": " + path);
+    }
+}
+
+EvalKeyFile::~EvalKeyFile() { close(fd); }
+
+bool EvalKeyFile::contains(const std::string& name) const
+{
+    return components.count(name) != 0;
+}
+
+std::vector<std::string> EvalKeyFile::names() const
+{
+    std::vector<std::string> res;
+    for (const auto& [name, component] : components) res.push_back(name);
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+std::shared_ptr<void> EvalKeyFile::load(const std::string& name,
+                                        const uint64_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Component& component = components.at(name);
+    const EvalKeyFileSection& section = component.section;
+    if (section.size != size)
+        throw std::runtime_error("EvalKey file: wrong size of section " +
+                                 name);
+    if (component.data) return component.data;
+    if (mode == Mode::map) {
+        // Aliases the mapping, which is unmapped with the last key using it.
+        component.data = std::shared_ptr<void>(
+            mapping, static_cast<char*>(mapping.get()) + section.offset);
+    }
+    else {
+        std::shared_ptr<char> data(
+            static_cast<char*>(std::aligned_alloc(
+                evalkeyfilealign, alignsection(section.size))),
+            std::free);
+        if (!data) throw std::bad_alloc();
+        for (uint64_t done = 0; done < section.size;) {
+            const ssize_t res = pread(fd, data.get() + done,
+                                      section.size - done,
+                                      section.offset + done);
+            if (res <= 0)
+                throw std::runtime_error("EvalKey file: cannot read " + name);
+            done += res;
+        }
+        component.data = data;
+    }
+    component.loaded.store(component.data.get(), std::memory_order_release);
+    return component.data;
+}
+
+int EvalKeyFile::compare(std::string_view name, const SectionName& section)
+{
+    const int res = name.substr(0, section.member.size())
+                        .compare(section.member);
+    if (res != 0) return res;
+    name.remove_prefix(section.member.size());
+    if (section.key.empty()) return name.empty() ? 0 : 1;
+    if (name.empty()) return -1;
+    if (name[0] != '/')
+        return static_cast<unsigned char>(name[0]) <
+                       static_cast<unsigned char>('/')
+                   ? -1
+                   : 1;
+    name.remove_prefix(1);
+    return name.compare(section.key);
+}
+
+void* EvalKeyFile::get(const std::string_view member,
+                       const std::string_view key, const uint64_t size)
+{
+    // The size was checked by the load which set loaded.
+    const auto it = components.find(SectionName{member, key});
+    if (it != components.end()) {
+        void* data = it->second.loaded.load(std::memory_order_acquire);
+        if (data != nullptr) return data;
+    }
+    std::string name(member);
+    if (!key.empty()) name.append("/").append(key);
+    return load(name, size).get();
+}
+
+void EvalKeyFile::advise(const EvalKeyFileSection& section,
+                         const int advice) const
+{
+    if (mode != Mode::map) return;
+    // madvise takes page aligned ranges. Sections sharing a page with this
+    // one only get their pages read again.
+    const uint64_t page = sysconf(_SC_PAGESIZE);
+    const uint64_t begin = section.offset / page * page;
+    madvise(static_cast<char*>(mapping.get()) + begin,
+            section.offset + section.size - begin, advice);
+}
+
+void EvalKeyFile::prefetch(const std::string& name)
+{
+    EvalKeyFileSection section;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        section = components.at(name).section;
+    }
+    load(name, section.size);
+    advise(section, MADV_WILLNEED);
+}
+
+void EvalKeyFile::evict(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Component& component = components.at(name);
+    if (!component.data) return;
+    component.loaded.store(nullptr, std::memory_order_release);
+    advise(component.section, MADV_DONTNEED);
+    component.data.reset();
+}
+
+uint64_t EvalKeyFile::loadedbytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t bytes = 0;
+    for (const auto& [name, component] : components)
+        if (component.data) bytes += component.section.size;
+    return bytes;
+}
+
+void* evalkeyfileload(EvalKeyFile& file, const std::string_view member,
+                      const std::string_view key, const uint64_t size)
+{
+    return file.get(member, key, size);
+}
+
+EvalKey mapevalkeyfile(const std::string& path)
+{
+    EvalKeyFile file(path);
+    checksections(file, path);
+    EvalKey ek;
+    SectionMapper mapper{file};
+    ek.foreachkey(mapper);
+    return ek;
+}
+
+EvalKey openevalkeyfile(const std::string& path, const EvalKeyFile::Mode mode)
+{
+    EvalKey ek;
+    ek.keyfile = std::make_shared<EvalKeyFile>(path, mode);
+    checksections(*ek.keyfile, path);
+    return ek;
+}
+
+}  // namespace TFHEpp
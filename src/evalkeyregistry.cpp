@@ -0,0 +1,183 @@
+#include <evalkeyfile.hpp>
+#include <evalkeyregistry.hpp>
+#include <stdexcept>
+
+namespace TFHEpp {
+
+namespace {
+
+struct KeyBytes {
+    uint64_t bytes = 0;
+
+    template <class T>
+    void operator()(const char*, const std::shared_ptr<T>& key)
+    {
+        if (key) bytes += sizeof(T);
+    }
+
+    template <class T>
+    void operator()(
+        const char*,
+        const std::unordered_map<std::string, std::shared_ptr<T>>& keys)
+    {
+        for (const auto& [name, key] : keys)
+            if (key) bytes += sizeof(T);
+    }
+};
+
+}  // namespace
+
+uint64_t evalkeybytes(const EvalKey& ek)
+{
+    KeyBytes counter;
+    ek.foreachkey(counter);
+    if (ek.keyfile) counter.bytes += ek.keyfile->loadedbytes();
+    return counter.bytes;
+}
+
+EvalKeyRegistry::Pin::Pin(EvalKeyRegistry* registry, const std::string& tenant,
+                          std::shared_ptr<const EvalKey> ek)
+    : registry(registry), tenant(tenant), ek(std::move(ek))
+{
+}
+
+EvalKeyRegistry::Pin::Pin(Pin&& pin) noexcept
+    : registry(pin.registry),
+      tenant(std::move(pin.tenant)),
+      ek(std::move(pin.ek))
+{
+    pin.registry = nullptr;
+}
+
+EvalKeyRegistry::Pin& EvalKeyRegistry::Pin::operator=(Pin&& pin) noexcept
+{
+    if (this != &pin) {
+        release();
+        registry = pin.registry;
+        tenant = std::move(pin.tenant);
+        ek = std::move(pin.ek);
+        pin.registry = nullptr;
+    }
+    return *this;
+}
+
+EvalKeyRegistry::Pin::~Pin() { release(); }
+
+void EvalKeyRegistry::Pin::release()
+{
+    if (registry) registry->unpin(tenant, *ek);
+    registry = nullptr;
+}
+
+EvalKeyRegistry::EvalKeyRegistry(Loader loader, const uint64_t capacitybytes)
+    : loader(std::move(loader)), capacitybytes(capacitybytes)
+{
+}
+
+EvalKeyRegistry::Pin EvalKeyRegistry::pin(const std::string& tenant)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = entries.find(tenant);
+    while (it != entries.end() && it->second.loading) {
+        loaded.wait(lock);
+        it = entries.find(tenant);
+    }
+    if (it != entries.end()) {
+        Entry& entry = it->second;
+        counters.hits++;
+        if (entry.pins++ == 0) counters.pinnedkeys++;
+        lru.splice(lru.begin(), lru, entry.lru);
+        return Pin(this, tenant, entry.ek);
+    }
+
+    counters.misses++;
+    entries[tenant].loading = true;
+    // The loader runs unlocked, so other tenants are served meanwhile.
+    lock.unlock();
+    std::shared_ptr<const EvalKey> ek;
+    try {
+        ek = loader(tenant);
+        if (!ek)
+            throw std::runtime_error(
+                "EvalKeyRegistry: the loader returned no key for tenant " +
+                tenant);
+    }
+    catch (...) {
+        lock.lock();
+        entries.erase(tenant);
+        loaded.notify_all();
+        throw;
+    }
+    const uint64_t bytes = evalkeybytes(*ek);
+    lock.lock();
+
+    Entry& entry = entries.at(tenant);
+    entry.ek = ek;
+    entry.bytes = bytes;
+    entry.pins = 1;
+    entry.loading = false;
+    lru.push_front(tenant);
+    entry.lru = lru.begin();
+    counters.residentkeys++;
+    counters.residentbytes += bytes;
+    counters.pinnedkeys++;
+    shrink();
+    loaded.notify_all();
+    return Pin(this, tenant, ek);
+}
+
+void EvalKeyRegistry::unpin(const std::string& tenant, const EvalKey& ek)
+{
+    // A lazily loaded key grows while it is used.
+    const uint64_t bytes = evalkeybytes(ek);
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry& entry = entries.at(tenant);
+    counters.residentbytes += bytes - entry.bytes;
+    entry.bytes = bytes;
+    if (--entry.pins == 0) counters.pinnedkeys--;
+    shrink();
+}
+
+void EvalKeyRegistry::shrink()
+{
+    for (auto it = lru.end(); counters.residentbytes > capacitybytes &&
+                              it != lru.begin();) {
+        --it;
+        Entry& entry = entries.at(*it);
+        if (entry.pins != 0) continue;
+        counters.evictions++;
+        counters.residentkeys--;
+        counters.residentbytes -= entry.bytes;
+        entries.erase(*it);
+        it = lru.erase(it);
+    }
+}
+
+bool EvalKeyRegistry::evict(const std::string& tenant)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = entries.find(tenant);
+    if (it == entries.end() || it->second.loading || it->second.pins != 0)
+        return false;
+    counters.evictions++;
+    counters.residentkeys--;
+    counters.residentbytes -= it->second.bytes;
+    lru.erase(it->second.lru);
+    entries.erase(it);
+    return true;
+}
+
+bool EvalKeyRegistry::resident(const std::string& tenant) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = entries.find(tenant);
+    return it != entries.end() && !it->second.loading;
+}
+
+EvalKeyRegistry::Stats EvalKeyRegistry::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+}  // namespace TFHEpp
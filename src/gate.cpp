@@ -61,6 +61,14 @@ INST(lvl0param);
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                    \
+    template void HomNAND<brP, mu, iksP>(      \
+        TLWE<typename iksP::targetP> & res,    \
+        const TLWE<typename brP::domainP> &ca, \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 #define INST(iksP, brP, mu, batch)                      \
     template void HomNANDbatch<iksP, brP, mu, batch>(        \
         TLWEn<typename brP::targetP, batch> & res,      \
@@ -69,6 +77,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_BATCH_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP, batch)                      \
+    template void HomNANDbatch<brP, mu, iksP, batch>(     \
+        TLWEn<typename iksP::targetP, batch> & res,     \
+        const TLWEn<typename brP::domainP, batch> &ca,  \
+        const TLWEn<typename brP::domainP, batch> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BATCH_BRIKS(INST)
+#undef INST
+
 #define INST(iksP, brP, mu)                                                     \
     template void HomNOR<iksP, brP, mu>(TLWE<typename brP::targetP> & res,      \
                                        const TLWE<typename iksP::domainP> &ca, \
@@ -77,6 +93,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_BATCH_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                    \
+    template void HomNOR<brP, mu, iksP>(       \
+        TLWE<typename iksP::targetP> & res,    \
+        const TLWE<typename brP::domainP> &ca, \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 #define INST(iksP, brP, mu)                      \
     template void HomXNOR<iksP, brP, mu>(        \
         TLWE<typename brP::targetP> & res,      \
@@ -85,6 +109,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                    \
+    template void HomXNOR<brP, mu, iksP>(      \
+        TLWE<typename iksP::targetP> & res,    \
+        const TLWE<typename brP::domainP> &ca, \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 
 #define INST(iksP, brP, mu)                                                     \
     template void HomAND<iksP, brP, mu>(TLWE<typename brP::targetP> & res,      \
@@ -94,6 +126,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                    \
+    template void HomAND<brP, mu, iksP>(       \
+        TLWE<typename iksP::targetP> & res,    \
+        const TLWE<typename brP::domainP> &ca, \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 
 #define INST(iksP, brP, mu)                                                    \
     template void HomOR<iksP, brP, mu>(TLWE<typename brP::targetP> & res,      \
@@ -103,6 +143,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                    \
+    template void HomOR<brP, mu, iksP>(        \
+        TLWE<typename iksP::targetP> & res,    \
+        const TLWE<typename brP::domainP> &ca, \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 
 #define INST(iksP, brP, mu)                                                     \
     template void HomXOR<iksP, brP, mu>(TLWE<typename brP::targetP> & res,      \
@@ -112,6 +160,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                    \
+    template void HomXOR<brP, mu, iksP>(       \
+        TLWE<typename iksP::targetP> & res,    \
+        const TLWE<typename brP::domainP> &ca, \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 #define INST(iksP, brP, mu)                      \
     template void HomANDNY<iksP, brP, mu>(       \
         TLWE<typename brP::targetP> & res,      \
@@ -120,6 +176,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                    \
+    template void HomANDNY<brP, mu, iksP>(     \
+        TLWE<typename iksP::targetP> & res,    \
+        const TLWE<typename brP::domainP> &ca, \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 #define INST(iksP, brP, mu)                      \
     template void HomANDYN<iksP, brP, mu>(       \
         TLWE<typename brP::targetP> & res,      \
@@ -128,6 +192,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                    \
+    template void HomANDYN<brP, mu, iksP>(     \
+        TLWE<typename iksP::targetP> & res,    \
+        const TLWE<typename brP::domainP> &ca, \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 #define INST(iksP, brP, mu)                      \
     template void HomORNY<iksP, brP, mu>(        \
         TLWE<typename brP::targetP> & res,      \
@@ -136,6 +208,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                    \
+    template void HomORNY<brP, mu, iksP>(      \
+        TLWE<typename iksP::targetP> & res,    \
+        const TLWE<typename brP::domainP> &ca, \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 
 #define INST(iksP, brP, mu)                      \
     template void HomORYN<iksP, brP, mu>(        \
@@ -145,6 +225,14 @@ TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_GATE_IKSBR(INST)
 #undef INST
 
+#define INST(brP, mu, iksP)                    \
+    template void HomORYN<brP, mu, iksP>(      \
+        TLWE<typename iksP::targetP> & res,    \
+        const TLWE<typename brP::domainP> &ca, \
+        const TLWE<typename brP::domainP> &cb, const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE_BRIKS(INST)
+#undef INST
+
 
 #define INST(P)                                                   \
     template void HomMUX<P>(TLWE<P> & res, const TLWE<P> &cs,     \
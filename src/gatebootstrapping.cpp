@@ -9,6 +9,16 @@ namespace TFHEpp {
         const BootstrappingKeyFFT<P> &bkfft,        \
         const Polynomial<typename P::targetP> &testvector)
 TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE(INST)
+TFHEPP_EXPLICIT_INSTANTIATION_BLIND_ROTATE_ADDENDS(INST)
+#undef INST
+
+#define INST(iksP, bkP)                                      \
+    template void ProgrammableBootstrapping<iksP, bkP>(      \
+        TLWE<typename bkP::targetP> & res,                   \
+        const TLWE<typename iksP::domainP> &tlwe,            \
+        const Polynomial<typename bkP::targetP> &testvector, \
+        const EvalKey &ek)
+TFHEPP_EXPLICIT_INSTANTIATION_GATE(INST)
 #undef INST
 
 }  // namespace TFHEpp
@@ -12,10 +12,13 @@ lweKey::lweKey()
                                                    lvl1param::key_value_max);
     std::uniform_int_distribution<int32_t> lvl2gen(lvl2param::key_value_min,
                                                    lvl2param::key_value_max);
-    for (typename lvl0param::T &i : lvl0) i = lvl0gen(generator);
-    for (typename lvlhalfparam::T &i : lvlhalf) i = lvlhalfgen(generator);
-    for (typename lvl1param::T &i : lvl1) i = lvl1gen(generator);
-    for (typename lvl2param::T &i : lvl2) i = lvl2gen(generator);
+    std::uniform_int_distribution<int32_t> lvl3gen(lvl3param::key_value_min,
+                                                   lvl3param::key_value_max);
+    for (typename lvl0param::T &i : lvl0) i = lvl0gen(noisegenerator);
+    for (typename lvlhalfparam::T &i : lvlhalf) i = lvlhalfgen(noisegenerator);
+    for (typename lvl1param::T &i : lvl1) i = lvl1gen(noisegenerator);
+    for (typename lvl2param::T &i : lvl2) i = lvl2gen(noisegenerator);
+    for (typename lvl3param::T &i : lvl3) i = lvl3gen(noisegenerator);
 }
 
 template <class P>
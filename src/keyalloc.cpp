@@ -0,0 +1,185 @@
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <keyalloc.hpp>
+#include <new>
+#include <stdexcept>
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+namespace TFHEpp {
+
+namespace {
+
+constexpr uint64_t hugepage2m = 1ULL << 21;
+constexpr uint64_t hugepage1g = 1ULL << 30;
+// MPOL_BIND of <linux/mempolicy.h>, not included to stay off libnuma.
+constexpr int mpolbind = 2;
+
+uint64_t roundup(const uint64_t bytes, const uint64_t unit)
+{
+    return (bytes + unit - 1) / unit * unit;
+}
+
+std::shared_ptr<void> mapping(void* addr, const uint64_t length)
+{
+    return std::shared_ptr<void>(
+        addr, [length](void* p) { munmap(p, length); });
+}
+
+std::shared_ptr<void> hugetlb(const uint64_t bytes, const uint64_t pagesize,
+                              const int flag)
+{
+    const uint64_t length = roundup(bytes, pagesize);
+    void* addr = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | flag, -1, 0);
+    if (addr == MAP_FAILED) return nullptr;
+    return mapping(addr, length);
+}
+
+// Maps 2 MB more than needed and trims the ends to get a 2 MB aligned range,
+// as only aligned 2 MB ranges can become huge pages.
+std::shared_ptr<void> transparent(const uint64_t bytes, bool& advised)
+{
+    const uint64_t length = roundup(bytes, hugepage2m);
+    char* addr =
+        static_cast<char*>(mmap(nullptr, length + hugepage2m,
+                                PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (addr == MAP_FAILED) return nullptr;
+    char* aligned = reinterpret_cast<char*>(
+        roundup(reinterpret_cast<uintptr_t>(addr), hugepage2m));
+    if (aligned != addr) munmap(addr, aligned - addr);
+    munmap(aligned + length, addr + hugepage2m - aligned);
+    advised = madvise(aligned, length, MADV_HUGEPAGE) == 0;
+    return mapping(aligned, length);
+}
+
+}  // namespace
+
+const char* keypagesname(const KeyPages pages)
+{
+    switch (pages) {
+    case KeyPages::normal:
+        return "normal";
+    case KeyPages::transparent:
+        return "transparent";
+    case KeyPages::hugetlb2m:
+        return "hugetlb2m";
+    case KeyPages::hugetlb1g:
+        return "hugetlb1g";
+    }
+    return "unknown";
+}
+
+std::ostream& operator<<(std::ostream& os, const KeyAllocation& allocation)
+{
+    os << allocation.name << ": " << allocation.bytes / 1000000 << "MB "
+       << keypagesname(allocation.granted);
+    if (allocation.granted != allocation.requested)
+        os << " (requested " << keypagesname(allocation.requested) << ")";
+    if (allocation.numanode >= 0)
+        os << (allocation.numabound ? " bound to node " : " unbound, node ")
+           << allocation.numanode;
+    return os;
+}
+
+KeyAllocPolicy keyallocpolicy(const int argc, const char* const argv[],
+                              const int first)
+{
+    KeyAllocPolicy policy;
+    if (argc > first) {
+        const std::string name = argv[first];
+        bool found = false;
+        for (const KeyPages pages :
+             {KeyPages::normal, KeyPages::transparent, KeyPages::hugetlb2m,
+              KeyPages::hugetlb1g})
+            if (name == keypagesname(pages)) {
+                policy.pages = pages;
+                found = true;
+            }
+        if (!found)
+            throw std::invalid_argument("unknown key pages: " + name);
+    }
+    if (argc > first + 1) policy.numanode = std::atoi(argv[first + 1]);
+    return policy;
+}
+
+std::shared_ptr<void> allocatekeymemory(const uint64_t bytes,
+                                        const KeyAllocPolicy& policy,
+                                        KeyAllocation& allocation)
+{
+    allocation.bytes = bytes;
+    allocation.requested = policy.pages;
+    allocation.numanode = policy.numanode;
+    allocation.numabound = false;
+
+    std::shared_ptr<void> memory;
+    uint64_t length = 0;
+    switch (policy.pages) {
+    case KeyPages::hugetlb1g:
+        memory = hugetlb(bytes, hugepage1g, MAP_HUGE_1GB);
+        allocation.granted = KeyPages::hugetlb1g;
+        length = roundup(bytes, hugepage1g);
+        if (memory) break;
+        [[fallthrough]];
+    case KeyPages::hugetlb2m:
+        memory = hugetlb(bytes, hugepage2m, MAP_HUGE_2MB);
+        allocation.granted = KeyPages::hugetlb2m;
+        length = roundup(bytes, hugepage2m);
+        if (memory) break;
+        [[fallthrough]];
+    case KeyPages::transparent: {
+        bool advised = false;
+        memory = transparent(bytes, advised);
+        allocation.granted =
+            advised ? KeyPages::transparent : KeyPages::normal;
+        length = roundup(bytes, hugepage2m);
+        if (memory) break;
+        allocation.granted = KeyPages::normal;
+        [[fallthrough]];
+    }
+    case KeyPages::normal:
+        // mbind needs pages of our own, which the heap does not give.
+        if (policy.numanode >= 0) {
+            length = roundup(bytes, sysconf(_SC_PAGESIZE));
+            void* addr = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (addr != MAP_FAILED) memory = mapping(addr, length);
+        }
+        allocation.granted = KeyPages::normal;
+        break;
+    }
+
+    const bool anonymous = memory != nullptr;
+    if (!anonymous) {
+        length = roundup(bytes, 64);
+        memory = std::shared_ptr<void>(std::aligned_alloc(64, length),
+                                       std::free);
+        if (!memory) throw std::bad_alloc();
+    }
+
+    // Binding before the first touch places every page on the node.
+    if (policy.numanode >= 0 && policy.numanode < 64 && anonymous) {
+        const unsigned long nodemask = 1UL << policy.numanode;
+        allocation.numabound =
+            syscall(SYS_mbind, memory.get(), length, mpolbind, &nodemask,
+                    sizeof(nodemask) * 8, 0) == 0;
+    }
+    // Anonymous mappings are zeroed by the kernel.
+    if (!anonymous) std::memset(memory.get(), 0, length);
+    return memory;
+}
+
+}  // namespace TFHEpp
@@ -0,0 +1,263 @@
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <keygenjob.hpp>
+#include <memory>
+#include <new>
+#include <stdexcept>
+
+namespace TFHEpp {
+
+namespace {
+
+constexpr std::array<char, 8> keygenprogressmagic = {'T', 'F', 'H', 'E',
+                                                     'p', 'p', 'K', 'G'};
+
+// Followed by the number of rows done of each component.
+struct KeyGenProgressHeader {
+    std::array<char, 8> magic;
+    uint64_t planhash;
+    uint64_t componentnum;
+};
+
+uint64_t alignsection(const uint64_t offset)
+{
+    return (offset + evalkeyfilealign - 1) / evalkeyfilealign *
+           evalkeyfilealign;
+}
+
+struct FileDescriptor {
+    int fd;
+    ~FileDescriptor()
+    {
+        if (fd >= 0) close(fd);
+    }
+};
+
+void pwriteall(const int fd, const void* data, const uint64_t size,
+               const uint64_t offset, const std::string& path)
+{
+    for (uint64_t done = 0; done < size;) {
+        const ssize_t res = pwrite(fd, static_cast<const char*>(data) + done,
+                                   size - done, offset + done);
+        if (res <= 0)
+            throw std::runtime_error("KeyGenJob: cannot write " + path);
+        done += res;
+    }
+}
+
+// Replaces the progress file atomically, so a crash leaves either the old or
+// the new one.
+void writeprogress(const std::string& path, const uint64_t planhash,
+                   const std::vector<uint64_t>& rowsdone)
+{
+    const KeyGenProgressHeader header = {keygenprogressmagic, planhash,
+                                         rowsdone.size()};
+    const std::string tmppath = path + ".tmp";
+    {
+        FileDescriptor file{
+            open(tmppath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+        if (file.fd < 0)
+            throw std::runtime_error("KeyGenJob: cannot create " + tmppath);
+        pwriteall(file.fd, &header, sizeof(header), 0, tmppath);
+        pwriteall(file.fd, rowsdone.data(), rowsdone.size() * sizeof(uint64_t),
+                  sizeof(header), tmppath);
+        if (fsync(file.fd) != 0)
+            throw std::runtime_error("KeyGenJob: cannot sync " + tmppath);
+    }
+    if (std::rename(tmppath.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("KeyGenJob: cannot rename " + tmppath);
+    // The rename is durable once the directory is.
+    const size_t slash = path.rfind('/');
+    const std::string dir =
+        slash == std::string::npos ? "." : path.substr(0, slash + 1);
+    FileDescriptor dirfile{open(dir.c_str(), O_RDONLY | O_DIRECTORY)};
+    if (dirfile.fd >= 0) fsync(dirfile.fd);
+}
+
+// Returns false if there is no progress file.
+bool readprogress(const std::string& path, const uint64_t planhash,
+                  std::vector<uint64_t>& rowsdone)
+{
+    FileDescriptor file{open(path.c_str(), O_RDONLY)};
+    if (file.fd < 0) return false;
+    KeyGenProgressHeader header;
+    const ssize_t size = rowsdone.size() * sizeof(uint64_t);
+    if (pread(file.fd, &header, sizeof(header), 0) != sizeof(header) ||
+        header.magic != keygenprogressmagic ||
+        header.componentnum != rowsdone.size() ||
+        pread(file.fd, rowsdone.data(), size, sizeof(header)) != size)
+        throw std::runtime_error("KeyGenJob: broken progress file " + path);
+    if (header.planhash != planhash)
+        throw std::runtime_error("KeyGenJob: " + path +
+                                 " is the progress of another job");
+    return true;
+}
+
+}  // namespace
+
+KeyGenJob::KeyGenJob(const std::string& path, const SecretKey& sk)
+    : path(path), sk(sk)
+{
+}
+
+void KeyGenJob::add(Component component)
+{
+    if (component.name.size() >= EvalKeyFileSection{}.name.size())
+        throw std::runtime_error("KeyGenJob: section name too long: " +
+                                 component.name);
+    for (const Component& added : components)
+        if (added.name == component.name)
+            throw std::runtime_error("KeyGenJob: " + component.name +
+                                     " added twice");
+    components.push_back(std::move(component));
+}
+
+uint64_t KeyGenJob::hashbytes(const void* data, const uint64_t size,
+                              uint64_t hash)
+{
+    // FNV-1a
+    for (uint64_t i = 0; i < size; i++) {
+        hash ^= static_cast<const unsigned char*>(data)[i];
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+// Identifies the keys a job generates, so that a progress file is only resumed
+// by a job adding the same keys under the same secret key.
+uint64_t KeyGenJob::planhash() const
+{
+    const uint64_t fingerprint = sk.params.fingerprint();
+    uint64_t hash = hashbytes(&fingerprint, sizeof(fingerprint));
+    hash = hashbytes(&sk.key, sizeof(sk.key), hash);
+    for (const Component& component : components) {
+        hash = hashbytes(component.name.data(), component.name.size() + 1,
+                         hash);
+        const std::array<uint64_t, 3> shape = {
+            component.rows, component.rowbytes, component.paramhash};
+        hash = hashbytes(shape.data(), sizeof(shape), hash);
+    }
+    return hash;
+}
+
+void KeyGenJob::run(const Callback& callback, const uint64_t blockrows)
+{
+    // The same layout as writeevalkeyfile.
+    std::vector<EvalKeyFileSection> sections(components.size());
+    uint64_t offset = sizeof(EvalKeyFileHeader) +
+                      sections.size() * sizeof(EvalKeyFileSection);
+    uint64_t rows = 0;
+    for (size_t i = 0; i < components.size(); i++) {
+        EvalKeyFileSection& section = sections[i];
+        section = {};
+        std::copy(components[i].name.begin(), components[i].name.end(),
+                  section.name.begin());
+        section.size = components[i].rows * components[i].rowbytes;
+        section.offset = alignsection(offset);
+        offset = section.offset + section.size;
+        rows += components[i].rows;
+    }
+    const uint64_t filesize = offset;
+
+    const std::string progresspath = path + ".progress";
+    const uint64_t plan = planhash();
+    std::vector<uint64_t> rowsdone(components.size(), 0);
+    FileDescriptor file{-1};
+    if (readprogress(progresspath, plan, rowsdone)) {
+        file.fd = open(path.c_str(), O_RDWR);
+        struct stat st;
+        if (file.fd < 0 || fstat(file.fd, &st) != 0 ||
+            static_cast<uint64_t>(st.st_size) != filesize)
+            throw std::runtime_error("KeyGenJob: cannot resume " + path);
+        // The size alone does not tell a reordered or renamed layout.
+        std::vector<EvalKeyFileSection> written(sections.size());
+        const ssize_t tablesize =
+            written.size() * sizeof(EvalKeyFileSection);
+        if (pread(file.fd, written.data(), tablesize,
+                  sizeof(EvalKeyFileHeader)) != tablesize ||
+            std::memcmp(written.data(), sections.data(), tablesize) != 0)
+            throw std::runtime_error("KeyGenJob: cannot resume " + path +
+                                     ", its sections differ from the job");
+        for (size_t i = 0; i < components.size(); i++)
+            if (rowsdone[i] > components[i].rows)
+                throw std::runtime_error("KeyGenJob: broken progress file " +
+                                         progresspath);
+    }
+    else {
+        // The header stays zero until the job is done.
+        file.fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (file.fd < 0 || ftruncate(file.fd, filesize) != 0)
+            throw std::runtime_error("KeyGenJob: cannot create " + path);
+        pwriteall(file.fd, sections.data(),
+                  sections.size() * sizeof(EvalKeyFileSection),
+                  sizeof(EvalKeyFileHeader), path);
+        if (fsync(file.fd) != 0)
+            throw std::runtime_error("KeyGenJob: cannot sync " + path);
+        writeprogress(progresspath, plan, rowsdone);
+    }
+
+    uint64_t done = 0;
+    for (const uint64_t componentdone : rowsdone) done += componentdone;
+    uint64_t generated = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t c = 0; c < components.size(); c++) {
+        const Component& component = components[c];
+        const Seed seed = keygenseedgen();
+        const uint64_t block = std::min(
+            component.rows,
+            blockrows != 0
+                ? blockrows
+                : std::max<uint64_t>(1, (64 << 20) / component.rowbytes));
+        std::unique_ptr<char, decltype(&std::free)> buffer(
+            static_cast<char*>(std::aligned_alloc(
+                evalkeyfilealign, alignsection(block * component.rowbytes))),
+            std::free);
+        if (!buffer) throw std::bad_alloc();
+        while (rowsdone[c] < component.rows) {
+            const uint64_t begin = rowsdone[c];
+            const uint64_t end = std::min(begin + block, component.rows);
+            TFHEPP_OMP(parallel for)
+            for (uint64_t i = begin; i < end; i++)
+                component.genrow(buffer.get() + (i - begin) * component.rowbytes,
+                                 i, seed);
+            pwriteall(file.fd, buffer.get(), (end - begin) * component.rowbytes,
+                      sections[c].offset + begin * component.rowbytes, path);
+            if (fdatasync(file.fd) != 0)
+                throw std::runtime_error("KeyGenJob: cannot sync " + path);
+            rowsdone[c] = end;
+            done += end - begin;
+            generated += end - begin;
+            writeprogress(progresspath, plan, rowsdone);
+
+            if (callback) {
+                const double seconds =
+                    std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+                callback(Progress{component.name, end, component.rows, done,
+                                  rows,
+                                  seconds > 0 ? generated / seconds : 0});
+            }
+        }
+    }
+
+    EvalKeyFileHeader header = {};
+    header.magic = evalkeyfilemagic;
+    header.version = evalkeyfileversion;
+    header.byteorder = evalkeyfilebyteorder;
+    header.fingerprint = sk.params.fingerprint();
+    header.sectionnum = sections.size();
+    header.filesize = filesize;
+    pwriteall(file.fd, &header, sizeof(header), 0, path);
+    if (fsync(file.fd) != 0)
+        throw std::runtime_error("KeyGenJob: cannot sync " + path);
+    std::remove(progresspath.c_str());
+}
+
+}  // namespace TFHEpp
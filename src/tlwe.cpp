@@ -25,6 +25,13 @@ TFHEPP_EXPLICIT_INSTANTIATION_TLWE(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_TLWE(INST)
 #undef INST
 
+#define INST(P)                                                      \
+    template TLWE<P> tlweSymEncryptSeeded<P>(                        \
+        const typename P::T p, const Key<P> &key, const Seed &seed, \
+        const uint64_t index)
+TFHEPP_EXPLICIT_INSTANTIATION_TLWE(INST)
+#undef INST
+
 #define INST(P) \
     template bool tlweSymDecrypt<P>(const TLWE<P> &c, const Key<P> &key)
 TFHEPP_EXPLICIT_INSTANTIATION_TLWE(INST)
@@ -23,10 +23,31 @@ TFHEPP_EXPLICIT_INSTANTIATION_TRLWE(INST)
 TFHEPP_EXPLICIT_INSTANTIATION_TRLWE(INST)
 #undef INST
 
+#define INST(P)                                                 \
+    template void trgswfftSymEncrypt<P>(TRGSWFFT<P> & trgswfft, \
+                                        const Polynomial<P> &p, \
+                                        const Key<P> &key)
+TFHEPP_EXPLICIT_INSTANTIATION_TRLWE(INST)
+#undef INST
+
 #define INST(P)                                                        \
     template TRGSWFFT<P> trgswfftSymEncrypt<P>(const Polynomial<P> &p, \
                                                const Key<P> &key)
 TFHEPP_EXPLICIT_INSTANTIATION_TRLWE(INST)
 #undef INST
 
+#define INST(P)                                                          \
+    template void trgswSymEncryptSeeded<P>(                              \
+        SeededTRGSW<P> & res, const Polynomial<P> &p, const Key<P> &key, \
+        const Seed &seed, const uint64_t index)
+TFHEPP_EXPLICIT_INSTANTIATION_TRLWE(INST)
+#undef INST
+
+#define INST(P)                                               \
+    template void trgswfftSeededExpand<P>(                    \
+        TRGSWFFT<P> & trgswfft, const SeededTRGSW<P> &seeded, \
+        const Seed &seed, const uint64_t index)
+TFHEPP_EXPLICIT_INSTANTIATION_TRLWE(INST)
+#undef INST
+
 }  // namespace TFHEpp
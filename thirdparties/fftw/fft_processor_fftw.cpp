@@ -12,6 +12,15 @@
 
 #define CAST_DOUBLE_TO_UINT32(d) ((uint32_t)((int64_t)(d)))
 
+// The transforms run on per-thread buffers through the new-array execute
+// interface, so a processor can be shared between threads. inbuf and outbuf
+// are only used for planning.
+namespace {
+constexpr int32_t max_Ns2 = TFHEpp::lvl2param::n / 2;
+alignas(64) thread_local fftw_complex thread_inbuf[max_Ns2];
+alignas(64) thread_local fftw_complex thread_outbuf[max_Ns2];
+}  // namespace
+
 FFT_Processor_FFTW::FFT_Processor_FFTW(const int32_t N)
     : _2N(2 * N), N(N), Ns2(N / 2)
 {
@@ -32,13 +41,13 @@ void FFT_Processor_FFTW::execute_reverse_int(double *res, const int32_t *a)
 {
     for (int i = 0; i < Ns2; i++) {
         auto tmp = twist[i] * std::complex((double)a[i], (double)a[Ns2 + i]);
-        inbuf[i][0] = tmp.real();
-        inbuf[i][1] = tmp.imag();
+        thread_inbuf[i][0] = tmp.real();
+        thread_inbuf[i][1] = tmp.imag();
     }
-    fftw_execute_dft(plan_forward, inbuf, outbuf);
+    fftw_execute_dft(plan_forward, thread_inbuf, thread_outbuf);
     for (int i = 0; i < Ns2; i++) {
-        res[i] = outbuf[i][0];
-        res[i + Ns2] = outbuf[i][1];
+        res[i] = thread_outbuf[i][0];
+        res[i + Ns2] = thread_outbuf[i][1];
     }
 }
 
@@ -52,25 +61,26 @@ void FFT_Processor_FFTW::execute_reverse_torus64(double *res, const uint64_t *a)
     for (int i = 0; i < Ns2; i++) {
         auto tmp = twist[i] * std::complex((double)((int64_t)a[i]),
                                            (double)((int64_t)a[Ns2 + i]));
-        inbuf[i][0] = tmp.real();
-        inbuf[i][1] = tmp.imag();
+        thread_inbuf[i][0] = tmp.real();
+        thread_inbuf[i][1] = tmp.imag();
     }
-    fftw_execute_dft(plan_forward, inbuf, outbuf);
+    fftw_execute_dft(plan_forward, thread_inbuf, thread_outbuf);
     for (int i = 0; i < Ns2; i++) {
-        res[i] = outbuf[i][0];
-        res[i + Ns2] = outbuf[i][1];
+        res[i] = thread_outbuf[i][0];
+        res[i + Ns2] = thread_outbuf[i][1];
     }
 }
 
 void FFT_Processor_FFTW::execute_direct_torus32(uint32_t *res, const double *a)
 {
     for (int i = 0; i < Ns2; i++) {
-        inbuf[i][0] = a[i] / Ns2;
-        inbuf[i][1] = a[Ns2 + i] / Ns2;
+        thread_inbuf[i][0] = a[i] / Ns2;
+        thread_inbuf[i][1] = a[Ns2 + i] / Ns2;
     }
-    fftw_execute_dft(plan_backward, inbuf, outbuf);
+    fftw_execute_dft(plan_backward, thread_inbuf, thread_outbuf);
     for (int i = 0; i < Ns2; i++) {
-        auto res_tmp = std::complex<double>(outbuf[i][0], outbuf[i][1]) *
+        auto res_tmp = std::complex<double>(thread_outbuf[i][0],
+                                            thread_outbuf[i][1]) *
                        std::conj(twist[i]);
         res[i] = CAST_DOUBLE_TO_UINT32(res_tmp.real());
         res[i + Ns2] = CAST_DOUBLE_TO_UINT32(res_tmp.imag());
@@ -82,12 +92,13 @@ void FFT_Processor_FFTW::execute_direct_torus32_rescale(uint32_t *res,
                                                         const double delta)
 {
     for (int i = 0; i < Ns2; i++) {
-        inbuf[i][0] = a[i] / Ns2;
-        inbuf[i][1] = a[Ns2 + i] / Ns2;
+        thread_inbuf[i][0] = a[i] / Ns2;
+        thread_inbuf[i][1] = a[Ns2 + i] / Ns2;
     }
-    fftw_execute_dft(plan_backward, inbuf, outbuf);
+    fftw_execute_dft(plan_backward, thread_inbuf, thread_outbuf);
     for (int i = 0; i < Ns2; i++) {
-        auto res_tmp = std::complex<double>(outbuf[i][0], outbuf[i][1]) *
+        auto res_tmp = std::complex<double>(thread_outbuf[i][0],
+                                            thread_outbuf[i][1]) *
                        std::conj(twist[i]);
         res[i] = CAST_DOUBLE_TO_UINT32(res_tmp.real() / (delta / 4));
         res[i + Ns2] = CAST_DOUBLE_TO_UINT32(res_tmp.imag() / (delta / 4));
@@ -97,13 +108,14 @@ void FFT_Processor_FFTW::execute_direct_torus32_rescale(uint32_t *res,
 void FFT_Processor_FFTW::execute_direct_torus64(uint64_t *res, const double *a)
 {
     for (int i = 0; i < Ns2; i++) {
-        inbuf[i][0] = a[i] / Ns2;
-        inbuf[i][1] = a[Ns2 + i] / Ns2;
+        thread_inbuf[i][0] = a[i] / Ns2;
+        thread_inbuf[i][1] = a[Ns2 + i] / Ns2;
     }
-    fftw_execute_dft(plan_backward, inbuf, outbuf);
+    fftw_execute_dft(plan_backward, thread_inbuf, thread_outbuf);
     double tmp[N];
     for (int i = 0; i < Ns2; i++) {
-        auto res_tmp = std::complex<double>(outbuf[i][0], outbuf[i][1]) *
+        auto res_tmp = std::complex<double>(thread_outbuf[i][0],
+                                            thread_outbuf[i][1]) *
                        std::conj(twist[i]);
         tmp[i] = res_tmp.real();
         tmp[i + Ns2] = res_tmp.imag();
@@ -128,13 +140,14 @@ void FFT_Processor_FFTW::execute_direct_torus64_rescale(uint64_t *res,
                                                         const double delta)
 {
     for (int i = 0; i < Ns2; i++) {
-        inbuf[i][0] = a[i] / Ns2;
-        inbuf[i][1] = a[Ns2 + i] / Ns2;
+        thread_inbuf[i][0] = a[i] / Ns2;
+        thread_inbuf[i][1] = a[Ns2 + i] / Ns2;
     }
-    fftw_execute_dft(plan_backward, inbuf, outbuf);
+    fftw_execute_dft(plan_backward, thread_inbuf, thread_outbuf);
     double tmp[N];
     for (int i = 0; i < Ns2; i++) {
-        auto res_tmp = std::complex<double>(outbuf[i][0], outbuf[i][1]) *
+        auto res_tmp = std::complex<double>(thread_outbuf[i][0],
+                                            thread_outbuf[i][1]) *
                        std::conj(twist[i]);
         tmp[i] = res_tmp.real();
         tmp[i + Ns2] = res_tmp.imag();
@@ -0,0 +1,65 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+// Compares the plain blind rotation with the unrolled (Addends > 1) variants
+// in terms of gate bootstrapping latency and bootstrapping key size.
+template <class iksP, class bkP>
+void bench(const TFHEpp::SecretKey &sk, const uint32_t num_test)
+{
+    std::random_device seed_gen;
+    std::default_random_engine engine(seed_gen());
+    std::uniform_int_distribution<uint32_t> binary(0, 1);
+
+    TFHEpp::EvalKey ek;
+    std::chrono::system_clock::time_point start, end;
+    start = std::chrono::system_clock::now();
+    ek.emplacebkfft<bkP>(sk);
+    end = std::chrono::system_clock::now();
+    const double keygen =
+        std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+            .count();
+    ek.emplaceiksk<iksP>(sk);
+
+    std::vector<TFHEpp::TLWE<typename iksP::domainP>> tlwe(num_test),
+        bootedtlwe(num_test);
+    std::vector<bool> p(num_test);
+    for (int i = 0; i < num_test; i++) p[i] = binary(engine) > 0;
+    for (int i = 0; i < num_test; i++)
+        tlwe[i] = TFHEpp::tlweSymEncrypt<typename iksP::domainP>(
+            p[i] ? iksP::domainP::mu : -iksP::domainP::mu,
+            sk.key.get<typename iksP::domainP>());
+
+    start = std::chrono::system_clock::now();
+    for (int test = 0; test < num_test; test++)
+        TFHEpp::GateBootstrapping<iksP, bkP, bkP::targetP::mu>(
+            bootedtlwe[test], tlwe[test], ek);
+    end = std::chrono::system_clock::now();
+
+    for (int i = 0; i < num_test; i++)
+        c_assert(p[i] == TFHEpp::tlweSymDecrypt<typename bkP::targetP>(
+                             bootedtlwe[i], sk.key.get<typename bkP::targetP>()));
+
+    const double elapsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+            .count();
+    std::cout << "Addends " << bkP::Addends << " (target N = "
+              << bkP::targetP::n << "): " << elapsed / num_test << "ms, key "
+              << (sizeof(TFHEpp::BootstrappingKeyFFT<bkP>) >> 20) << "MiB, "
+              << "keygen " << keygen << "ms" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t num_test = argc > 1 ? std::atoi(argv[1]) : 100;
+
+    TFHEpp::SecretKey sk;
+    bench<TFHEpp::lvl10param, TFHEpp::lvl01param>(sk, num_test);
+    bench<TFHEpp::lvl10param, TFHEpp::lvl01Addends2param>(sk, num_test);
+    bench<TFHEpp::lvl10param, TFHEpp::lvl01Addends3param>(sk, num_test);
+    bench<TFHEpp::lvl20param, TFHEpp::lvl02param>(sk, num_test);
+    bench<TFHEpp::lvl20param, TFHEpp::lvl02Addends2param>(sk, num_test);
+    std::cout << "Passed" << std::endl;
+}
@@ -0,0 +1,71 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+// Blind rotation on the torus-domain key, transformed per CMUX, against the
+// FFT-resident key. Both keys hold the same TRGSWs, so the results must be
+// identical; the timings show where streaming half the bytes pays for the
+// extra transforms. Batches run in parallel when built with OpenMP, which is
+// where the memory traffic of the key starts to dominate.
+template <class P>
+void bench(const TFHEpp::SecretKey &sk, const uint32_t num_test)
+{
+    std::random_device seed_gen;
+    std::default_random_engine engine(seed_gen());
+    std::uniform_int_distribution<typename P::domainP::T> torus(
+        0, std::numeric_limits<typename P::domainP::T>::max());
+
+    TFHEpp::EvalKey ek;
+    ek.emplacebk<P>(sk);
+    ek.emplacebk2bkfft<P>();
+    const TFHEpp::BootstrappingKey<P> &bk = ek.getbk<P>();
+    const TFHEpp::BootstrappingKeyFFT<P> &bkfft = ek.getbkfft<P>();
+
+    std::vector<TFHEpp::TLWE<typename P::domainP>> tlwe(num_test);
+    for (TFHEpp::TLWE<typename P::domainP> &c : tlwe)
+        for (typename P::domainP::T &a : c) a = torus(engine);
+    const TFHEpp::Polynomial<typename P::targetP> testvector =
+        TFHEpp::mupolygen<typename P::targetP, P::targetP::mu>();
+
+    std::vector<TFHEpp::TRLWE<typename P::targetP>> resident(num_test),
+        compact(num_test);
+    std::chrono::system_clock::time_point start, end;
+    start = std::chrono::system_clock::now();
+    TFHEPP_OMP(parallel for)
+    for (int test = 0; test < num_test; test++)
+        TFHEpp::BlindRotate<P>(resident[test], tlwe[test], bkfft, testvector);
+    end = std::chrono::system_clock::now();
+    const double residenttime =
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+            .count();
+    start = std::chrono::system_clock::now();
+    TFHEPP_OMP(parallel for)
+    for (int test = 0; test < num_test; test++)
+        TFHEpp::BlindRotate<P>(compact[test], tlwe[test], bk, testvector);
+    end = std::chrono::system_clock::now();
+    const double compacttime =
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+            .count();
+
+    for (int test = 0; test < num_test; test++)
+        c_assert(compact[test] == resident[test]);
+
+    std::cout << "target N = " << P::targetP::n << ": FFT-resident "
+              << residenttime / num_test / 1000 << "ms with "
+              << (sizeof(TFHEpp::BootstrappingKeyFFT<P>) >> 20)
+              << "MiB, compact " << compacttime / num_test / 1000 << "ms with "
+              << (sizeof(TFHEpp::BootstrappingKey<P>) >> 20) << "MiB"
+              << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t num_test = argc > 1 ? std::atoi(argv[1]) : 5;
+
+    TFHEpp::SecretKey sk;
+    bench<TFHEpp::lvl01param>(sk, num_test);
+    bench<TFHEpp::lvl02param>(sk, num_test);
+    std::cout << "Passed" << std::endl;
+}
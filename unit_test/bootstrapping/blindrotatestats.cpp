@@ -0,0 +1,94 @@
+#include <iostream>
+#include <random>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+// Checks that BlindRotatebatch compacts out zero rotations, that it matches
+// BlindRotate ciphertext by ciphertext and that the work counters add up.
+int main()
+{
+    constexpr int batch = 8;
+    using bkP = lvl01param;
+    using P = bkP::targetP;
+    std::random_device seed_gen;
+    std::default_random_engine engine(seed_gen());
+    std::uniform_int_distribution<uint32_t> binary(0, 1);
+
+    SecretKey sk;
+    EvalKey ek;
+    ek.emplacebkfft<bkP>(sk);
+
+    std::unique_ptr<TLWEn<bkP::domainP, batch>> tlwePtr =
+        std::make_unique<TLWEn<bkP::domainP, batch>>();
+    TLWEn<bkP::domainP, batch> &tlwe = *tlwePtr;
+    std::array<bool, batch> p;
+    for (int j = 0; j < batch; j++) {
+        p[j] = binary(engine) > 0;
+        tlwe[j] = tlweSymEncrypt<bkP::domainP>(
+            p[j] ? bkP::domainP::mu : -bkP::domainP::mu,
+            sk.key.get<bkP::domainP>());
+    }
+    // Zero the mask of every other ciphertext on a range of indices so that
+    // the batch has to be compacted there.
+    for (int j = 0; j < batch; j += 2)
+        for (int i = 0; i < bkP::domainP::n / 2; i++) tlwe[j][i] = 0;
+
+    const Polynomial<P> testvector = mupolygen<P, P::mu>();
+    std::unique_ptr<TRLWEn<P, batch>> accbatchPtr =
+        std::make_unique<TRLWEn<P, batch>>();
+    resetblindrotatestats();
+    BlindRotatebatch<bkP, batch>(*accbatchPtr, tlwe, ek.getbkfft<bkP>(),
+                                 testvector);
+    const BlindRotateStats batchstats = blindrotatestats;
+
+    BlindRotateStats singlestats = {};
+    for (int j = 0; j < batch; j++) {
+        TRLWE<P> acc;
+        resetblindrotatestats();
+        BlindRotate<bkP>(acc, tlwe[j], ek.getbkfft<bkP>(), testvector);
+        c_assert(blindrotatestats.cmux_executed +
+                     blindrotatestats.cmux_skipped ==
+                 bkP::domainP::n);
+        c_assert(blindrotatestats.ifft ==
+                 blindrotatestats.cmux_executed * (P::k + 1) * P::l);
+        c_assert(blindrotatestats.fft ==
+                 blindrotatestats.cmux_executed * (P::k + 1));
+        singlestats.cmux_executed += blindrotatestats.cmux_executed;
+        singlestats.cmux_skipped += blindrotatestats.cmux_skipped;
+        singlestats.fft += blindrotatestats.fft;
+        singlestats.ifft += blindrotatestats.ifft;
+
+        for (int k = 0; k <= P::k; k++)
+            for (int i = 0; i < P::n; i++)
+                c_assert(acc[k][i] == (*accbatchPtr)[k][j][i]);
+        // The zeroed ciphertexts no longer encrypt p[j].
+        if (j % 2 == 0) continue;
+        TLWE<P> res;
+        SampleExtractIndex<P>(res, acc, 0);
+        c_assert(p[j] == tlweSymDecrypt<P>(res, sk.key.get<P>()));
+    }
+
+    c_assert(batchstats.cmux_executed == singlestats.cmux_executed);
+    c_assert(batchstats.cmux_skipped == singlestats.cmux_skipped);
+    c_assert(batchstats.cmux_skipped >= batch / 2 * bkP::domainP::n / 2);
+    c_assert(batchstats.fft == singlestats.fft);
+    c_assert(batchstats.ifft == singlestats.ifft);
+
+    // Transforms outside a blind rotation are not counted.
+    resetblindrotatestats();
+    {
+        Polynomial<P> poly = {};
+        PolynomialInFD<P> polyfft;
+        TwistIFFT<P>(polyfft, poly);
+        TwistFFT<P>(poly, polyfft);
+    }
+    c_assert(blindrotatestats.fft == 0 && blindrotatestats.ifft == 0);
+
+    std::cout << "CMUX executed: " << batchstats.cmux_executed
+              << " skipped: " << batchstats.cmux_skipped
+              << " FFT: " << batchstats.fft << " IFFT: " << batchstats.ifft
+              << std::endl;
+    std::cout << "Passed" << std::endl;
+}
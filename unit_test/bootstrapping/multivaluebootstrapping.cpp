@@ -0,0 +1,62 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+int main(int argc, char **argv)
+{
+    const uint32_t num_test = argc > 1 ? std::atoi(argv[1]) : 100;
+    using iksP = lvl10param;
+    using bkP = lvl01param;
+    using P = bkP::targetP;
+    constexpr uint32_t plain_modulus = P::plain_modulus;
+    constexpr uint32_t num_out = 2;
+
+    std::random_device seed_gen;
+    std::default_random_engine engine(seed_gen());
+    std::uniform_int_distribution<typename P::T> message(0, plain_modulus - 1);
+
+    SecretKey sk;
+    EvalKey ek;
+    ek.emplacebkfft<bkP>(sk);
+    ek.emplaceiksk<iksP>(sk);
+
+    // Sum and carry of m + 5 mod plain_modulus.
+    std::array<std::array<typename P::T, plain_modulus>, num_out> luts;
+    for (uint32_t m = 0; m < plain_modulus; m++) {
+        luts[0][m] = (m + 5) % plain_modulus;
+        luts[1][m] = (m + 5) / plain_modulus;
+    }
+    const Polynomial<P> testvector =
+        lutpolygen<P, plain_modulus, num_out>(luts);
+
+    std::vector<typename P::T> p(num_test);
+    std::vector<TLWE<P>> tlwe(num_test);
+    std::vector<std::array<TLWE<P>, num_out>> res(num_test);
+    for (int i = 0; i < num_test; i++) {
+        p[i] = message(engine);
+        tlwe[i] = tlweSymEncrypt<P>(p[i] * lutdelta<P, plain_modulus>(),
+                                    sk.key.get<P>());
+    }
+
+    std::chrono::system_clock::time_point start, end;
+    start = std::chrono::system_clock::now();
+    for (int i = 0; i < num_test; i++)
+        ProgrammableBootstrapping<iksP, bkP, num_out>(res[i], tlwe[i],
+                                                      testvector, ek);
+    end = std::chrono::system_clock::now();
+
+    for (int i = 0; i < num_test; i++)
+        for (uint32_t j = 0; j < num_out; j++)
+            c_assert((tlweSymIntDecrypt<P, 2 * plain_modulus>(
+                         res[i][j], sk.key.get<P>())) == luts[j][p[i]]);
+    std::cout << "Passed" << std::endl;
+    double elapsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+            .count();
+    std::cout << elapsed / num_test << "ms for " << num_out << " outputs"
+              << std::endl;
+}
@@ -0,0 +1,67 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+int main(int argc, char **argv)
+{
+    const uint32_t num_test = argc > 1 ? std::atoi(argv[1]) : 100;
+    using iksP = lvl10param;
+    using bkP = lvl01param;
+    using P = bkP::targetP;
+    constexpr uint32_t plain_modulus = P::plain_modulus;
+
+    std::random_device seed_gen;
+    std::default_random_engine engine(seed_gen());
+    std::uniform_int_distribution<typename P::T> message(0, plain_modulus - 1);
+
+    SecretKey sk;
+    EvalKey ek;
+    ek.emplacebkfft<bkP>(sk);
+    ek.emplaceiksk<iksP>(sk);
+
+    // f(m) = m^2 + 3 and g(m) = 7 - m, both mod plain_modulus. f is given by
+    // its table and evaluated with a test vector built here, g is a
+    // LookupTable made from the function.
+    std::array<typename P::T, plain_modulus> f;
+    for (uint32_t m = 0; m < plain_modulus; m++)
+        f[m] = (m * m + 3) % plain_modulus;
+    const Polynomial<P> ftestvector = lutpolygen<P, plain_modulus>(f);
+    const LookupTable<P, plain_modulus> g(
+        [](const typename P::T m) { return plain_modulus - 1 - m; });
+    c_assert((g.testvector == lutpolygen<P, plain_modulus>(g.table)));
+    c_assert((LookupTable<P, plain_modulus>(f).testvector == ftestvector));
+
+    std::vector<typename P::T> p(num_test);
+    std::vector<TLWE<P>> tlwe(num_test), ftlwe(num_test), gftlwe(num_test);
+    for (int i = 0; i < num_test; i++) {
+        p[i] = message(engine);
+        tlwe[i] = tlweSymEncrypt<P>(p[i] * lutdelta<P, plain_modulus>(),
+                                    sk.key.get<P>());
+    }
+
+    std::chrono::system_clock::time_point start, end;
+    start = std::chrono::system_clock::now();
+    for (int i = 0; i < num_test; i++)
+        ProgrammableBootstrapping<iksP, bkP>(ftlwe[i], tlwe[i], ftestvector,
+                                             ek);
+    end = std::chrono::system_clock::now();
+    // The output encoding is the input encoding, so PBSs can be chained.
+    for (int i = 0; i < num_test; i++)
+        ProgrammableBootstrapping<iksP, bkP>(gftlwe[i], ftlwe[i], g, ek);
+
+    for (int i = 0; i < num_test; i++) {
+        c_assert((tlweSymIntDecrypt<P, 2 * plain_modulus>(
+                     ftlwe[i], sk.key.get<P>())) == f[p[i]]);
+        c_assert((tlweSymIntDecrypt<P, 2 * plain_modulus>(
+                     gftlwe[i], sk.key.get<P>())) == g.table[f[p[i]]]);
+    }
+    std::cout << "Passed" << std::endl;
+    double elapsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+            .count();
+    std::cout << elapsed / num_test << "ms" << std::endl;
+}
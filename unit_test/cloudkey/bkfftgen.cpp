@@ -0,0 +1,72 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+// Encrypting straight into the Fourier domain gives the same TRGSWFFT as
+// transforming the TRGSW encrypted from the same randomness.
+template <class P>
+void test(const SecretKey &sk)
+{
+    Polynomial<P> p = {};
+    p[0] = 1;
+    const Seed seed = seedgen();
+    alignas(64) TRGSWFFT<P> expected, res;
+    {
+        GeneratorSeed trgswseed(seed, 0);
+        expected = ApplyFFT2trgsw<P>(trgswSymEncrypt<P>(p, sk.key.get<P>()));
+    }
+    {
+        GeneratorSeed trgswseed(seed, 0);
+        trgswfftSymEncrypt<P>(res, p, sk.key.get<P>());
+    }
+    c_assert(std::memcmp(&res, &expected, sizeof(TRGSWFFT<P>)) == 0);
+}
+
+int main()
+{
+    SecretKey sk;
+    test<lvl1param>(sk);
+    test<lvl2param>(sk);
+
+    // bkfftgen and emplacebk2bkfft agree for the same seed.
+    using brP = lvl01param;
+    const Seed seed = seedgen();
+    std::unique_ptr<BootstrappingKeyFFT<brP>> bkfft(
+        new (std::align_val_t(64)) BootstrappingKeyFFT<brP>());
+    std::chrono::system_clock::time_point start, end;
+    start = std::chrono::system_clock::now();
+    {
+        GeneratorSeed keyseed(seed, 0);
+        bkfftgen<brP>(*bkfft, sk);
+    }
+    end = std::chrono::system_clock::now();
+    std::cout << "bkfftgen: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end -
+                                                                       start)
+                     .count()
+              << "ms" << std::endl;
+
+    EvalKey ek;
+    {
+        GeneratorSeed keyseed(seed, 0);
+        ek.emplacebk<brP>(sk);
+    }
+    ek.emplacebk2bkfft<brP>();
+    c_assert(std::memcmp(bkfft.get(), &ek.getbkfft<brP>(),
+                         sizeof(BootstrappingKeyFFT<brP>)) == 0);
+
+    ek.emplaceiksk<lvl10param>(sk);
+    for (int i = 0; i < 4; i++) {
+        const bool a = i & 1, b = (i >> 1) & 1;
+        TLWE<lvl1param> res;
+        HomNAND(res, bootsSymEncrypt<lvl1param>({a}, sk)[0],
+                bootsSymEncrypt<lvl1param>({b}, sk)[0], ek);
+        c_assert(bootsSymDecrypt<lvl1param>({res}, sk)[0] == !(a & b));
+    }
+    std::cout << "Passed" << std::endl;
+}
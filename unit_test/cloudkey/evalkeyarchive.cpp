@@ -0,0 +1,57 @@
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+int main()
+{
+    SecretKey sk;
+    EvalKey ek(sk);
+    ek.emplaceiksk<lvl10param>(sk);
+    ek.emplaceseediksk<lvl10param>(sk);
+
+    std::stringstream ss;
+    {
+        cereal::PortableBinaryOutputArchive ar(ss);
+        ar(ek);
+    }
+    EvalKey loaded;
+    {
+        cereal::PortableBinaryInputArchive ar(ss);
+        ar(loaded);
+    }
+    c_assert(loaded.params == ek.params);
+    c_assert(std::memcmp(&loaded.getiksk<lvl10param>(),
+                         &ek.getiksk<lvl10param>(),
+                         sizeof(KeySwitchingKey<lvl10param>)) == 0);
+    c_assert(std::memcmp(&loaded.getseediksk<lvl10param>(),
+                         &ek.getseediksk<lvl10param>(),
+                         sizeof(SeededKeySwitchingKey<lvl10param>)) == 0);
+
+    // Archives of earlier builds have no class version and end after
+    // privksklvl22.
+    std::stringstream oldss;
+    {
+        cereal::PortableBinaryOutputArchive ar(oldss);
+        ar(ek.params, ek.bklvl01, ek.bklvlh1, ek.bklvl02, ek.bklvlh2,
+           ek.bkfftlvl01, ek.bkfftlvlh1, ek.bkfftlvl02, ek.bkfftlvlh2,
+           ek.bknttlvl01, ek.bknttlvlh1, ek.bknttlvl02, ek.bknttlvlh2,
+           ek.iksklvl10, ek.iksklvl1h, ek.iksklvl20, ek.iksklvl21,
+           ek.iksklvl22, ek.iksklvl31, ek.privksklvl11, ek.privksklvl21,
+           ek.privksklvl22);
+    }
+    EvalKey oldloaded;
+    {
+        cereal::PortableBinaryInputArchive ar(oldss);
+        ar(oldloaded);
+    }
+    c_assert(oldloaded.params == ek.params);
+    c_assert(std::memcmp(&oldloaded.getiksk<lvl10param>(),
+                         &ek.getiksk<lvl10param>(),
+                         sizeof(KeySwitchingKey<lvl10param>)) == 0);
+    c_assert(oldloaded.seediksklvl10 == nullptr);
+    std::cout << "Passed" << std::endl;
+}
@@ -0,0 +1,150 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+template <class Key>
+bool samekey(const std::shared_ptr<Key> &a, const std::shared_ptr<Key> &b)
+{
+    return std::memcmp(a.get(), b.get(), sizeof(Key)) == 0;
+}
+
+template <class Key>
+bool aligned(const std::shared_ptr<Key> &key)
+{
+    return reinterpret_cast<uintptr_t>(key.get()) % evalkeyfilealign == 0;
+}
+
+// Writes keys to a file, maps it back and checks that the mapped keys are the
+// written ones, usable in place, that lazily opened files load only what is
+// used, and that foreign files are rejected.
+int main()
+{
+    const std::string path = "evalkeyfile_test.tfhe";
+    SecretKey sk;
+    EvalKey ek(sk);
+    ek.emplacebkfft<lvl01param>(sk);
+    ek.emplaceiksk<lvl10param>(sk);
+    ek.emplaceahk<lvl1param>(sk);
+    ek.emplaceseediksk<lvl10param>(sk);
+
+    std::chrono::system_clock::time_point start, end;
+    start = std::chrono::system_clock::now();
+    writeevalkeyfile(path, ek);
+    end = std::chrono::system_clock::now();
+    std::cout << "write: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end -
+                                                                       start)
+                     .count()
+              << "ms" << std::endl;
+
+    start = std::chrono::system_clock::now();
+    {
+        const EvalKey mapped = mapevalkeyfile(path);
+        end = std::chrono::system_clock::now();
+        std::cout << "map: "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(
+                         end - start)
+                         .count()
+                  << "us" << std::endl;
+        c_assert(mapped.params == ek.params);
+        c_assert(samekey(mapped.bkfftlvl01, ek.bkfftlvl01));
+        c_assert(samekey(mapped.iksklvl10, ek.iksklvl10));
+        c_assert(samekey(mapped.ahklvl1, ek.ahklvl1));
+        c_assert(samekey(mapped.seediksklvl10, ek.seediksklvl10));
+        c_assert(aligned(mapped.bkfftlvl01) && aligned(mapped.iksklvl10) &&
+                 aligned(mapped.ahklvl1) && aligned(mapped.seediksklvl10));
+        c_assert(!mapped.bkfftlvl02 && !mapped.iksklvl21 &&
+                 mapped.privksklvl21.empty());
+
+        for (int i = 0; i < 4; i++) {
+            const bool a = i & 1, b = (i >> 1) & 1;
+            TLWE<lvl1param> res;
+            HomNAND(res, bootsSymEncrypt<lvl1param>({a}, sk)[0],
+                    bootsSymEncrypt<lvl1param>({b}, sk)[0], mapped);
+            c_assert(bootsSymDecrypt<lvl1param>({res}, sk)[0] == !(a & b));
+        }
+
+        // Writes to a mapped key stay in this mapping.
+        mapped.getiksk<lvl10param>()[0][0][0][0] ^= 1;
+        c_assert(!samekey(mapped.iksklvl10, ek.iksklvl10));
+        c_assert(samekey(mapevalkeyfile(path).iksklvl10, ek.iksklvl10));
+    }
+
+    // Opened lazily, only the keys a gate uses are loaded.
+    for (const EvalKeyFile::Mode mode :
+         {EvalKeyFile::Mode::map, EvalKeyFile::Mode::read}) {
+        const EvalKey lazy = openevalkeyfile(path, mode);
+        EvalKeyFile &file = *lazy.keyfile;
+        c_assert(file.loadedbytes() == 0);
+        c_assert(!lazy.bkfftlvl01 && file.contains("bkfftlvl01"));
+        TLWE<lvl1param> res;
+        HomNAND(res, bootsSymEncrypt<lvl1param>({1}, sk)[0],
+                bootsSymEncrypt<lvl1param>({1}, sk)[0], lazy);
+        c_assert(bootsSymDecrypt<lvl1param>({res}, sk)[0] == 0);
+        c_assert(file.loadedbytes() == sizeof(BootstrappingKeyFFT<lvl01param>) +
+                                           sizeof(KeySwitchingKey<lvl10param>));
+        c_assert(std::memcmp(&lazy.getbkfft<lvl01param>(), ek.bkfftlvl01.get(),
+                             sizeof(BootstrappingKeyFFT<lvl01param>)) == 0);
+
+        file.prefetch("ahklvl1");
+        c_assert(file.loadedbytes() ==
+                 sizeof(BootstrappingKeyFFT<lvl01param>) +
+                     sizeof(KeySwitchingKey<lvl10param>) +
+                     sizeof(AnnihilateKey<lvl1param>));
+        file.evict("ahklvl1");
+        file.evict("bkfftlvl01");
+        c_assert(file.loadedbytes() == sizeof(KeySwitchingKey<lvl10param>));
+        // An evicted key is loaded again on its next use.
+        c_assert(std::memcmp(&lazy.getahk<lvl1param>(), ek.ahklvl1.get(),
+                             sizeof(AnnihilateKey<lvl1param>)) == 0);
+        c_assert(file.loadedbytes() == sizeof(KeySwitchingKey<lvl10param>) +
+                                           sizeof(AnnihilateKey<lvl1param>));
+    }
+
+    const auto rejected = [&path] {
+        try {
+            mapevalkeyfile(path);
+        }
+        catch (const std::runtime_error &e) {
+            return true;
+        }
+        return false;
+    };
+
+    // A section overlapping the section table is rejected.
+    {
+        std::fstream fs(path, std::ios::in | std::ios::out | std::ios::binary);
+        EvalKeyFileSection section;
+        fs.seekg(sizeof(EvalKeyFileHeader));
+        fs.read(reinterpret_cast<char *>(&section), sizeof(section));
+        const uint64_t offset = section.offset;
+        section.offset = sizeof(EvalKeyFileHeader);
+        fs.seekp(sizeof(EvalKeyFileHeader));
+        fs.write(reinterpret_cast<const char *>(&section), sizeof(section));
+        fs.flush();
+        c_assert(rejected());
+        section.offset = offset;
+        fs.seekp(sizeof(EvalKeyFileHeader));
+        fs.write(reinterpret_cast<const char *>(&section), sizeof(section));
+    }
+    c_assert(!rejected());
+
+    // A file claiming other parameters is rejected.
+    {
+        std::fstream fs(path, std::ios::in | std::ios::out | std::ios::binary);
+        EvalKeyFileHeader header;
+        fs.read(reinterpret_cast<char *>(&header), sizeof(header));
+        header.fingerprint ^= 1;
+        fs.seekp(0);
+        fs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    }
+    c_assert(rejected());
+    std::remove(path.c_str());
+    std::cout << "Passed" << std::endl;
+}
@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+// Serves several tenants from a registry holding two keys at most, all of
+// them mapping the same key file, and checks residency, eviction order,
+// pinning and the stats.
+int main()
+{
+    const std::string path = "evalkeyregistry_test.tfhe";
+    SecretKey sk;
+    uint64_t keybytes;
+    {
+        EvalKey ek(sk);
+        ek.emplacebkfft<lvl01param>(sk);
+        ek.emplaceiksk<lvl10param>(sk);
+        keybytes = evalkeybytes(ek);
+        writeevalkeyfile(path, ek);
+    }
+
+    uint64_t loads = 0;
+    EvalKeyRegistry registry(
+        [&](const std::string &tenant) -> std::shared_ptr<const EvalKey> {
+            if (tenant == "unknown") throw std::runtime_error("no key");
+            if (tenant == "empty") return nullptr;
+            loads++;
+            return std::make_shared<const EvalKey>(mapevalkeyfile(path));
+        },
+        keybytes * 5 / 2);
+
+    registry.pin("a");
+    registry.pin("b");
+    registry.pin("a");
+    c_assert(registry.resident("a") && registry.resident("b"));
+    // c pushes out b, the least recently used.
+    registry.pin("c");
+    c_assert(!registry.resident("b"));
+    EvalKeyRegistry::Stats stats = registry.stats();
+    c_assert(stats.hits == 1 && stats.misses == 3 && stats.evictions == 1);
+    c_assert(stats.residentkeys == 2 && stats.residentbytes == 2 * keybytes);
+
+    {
+        // Pinned keys stay while the budget is exceeded, and the least
+        // recently used unpinned one goes when they are released.
+        EvalKeyRegistry::Pin a = registry.pin("a");
+        EvalKeyRegistry::Pin c = registry.pin("c");
+        EvalKeyRegistry::Pin d = registry.pin("d");
+        stats = registry.stats();
+        c_assert(stats.residentkeys == 3 && stats.pinnedkeys == 3);
+        c_assert(!registry.evict("a"));
+
+        for (int i = 0; i < 4; i++) {
+            const bool pa = i & 1, pb = (i >> 1) & 1;
+            TLWE<lvl1param> res;
+            HomNAND(res, bootsSymEncrypt<lvl1param>({pa}, sk)[0],
+                    bootsSymEncrypt<lvl1param>({pb}, sk)[0], *d);
+            c_assert(bootsSymDecrypt<lvl1param>({res}, sk)[0] == !(pa & pb));
+        }
+        { EvalKeyRegistry::Pin released = std::move(a); }
+        c_assert(!registry.resident("a"));
+    }
+    stats = registry.stats();
+    c_assert(stats.residentkeys == 2 && stats.pinnedkeys == 0);
+
+    bool thrown = false;
+    try {
+        registry.pin("unknown");
+    }
+    catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    c_assert(thrown && !registry.resident("unknown"));
+    thrown = false;
+    try {
+        registry.pin("empty");
+    }
+    catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    c_assert(thrown && !registry.resident("empty"));
+
+    // Concurrent pins of a tenant share a single load.
+    c_assert(registry.evict("c") && registry.evict("d"));
+    const uint64_t before = loads;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++)
+        threads.emplace_back([&] { registry.pin("e"); });
+    for (std::thread &thread : threads) thread.join();
+    c_assert(loads == before + 1);
+
+    stats = registry.stats();
+    std::cout << "hits " << stats.hits << ", misses " << stats.misses
+              << ", evictions " << stats.evictions << ", resident "
+              << stats.residentkeys << " keys, "
+              << stats.residentbytes / 1000000 << "MB" << std::endl;
+    std::remove(path.c_str());
+    std::cout << "Passed" << std::endl;
+}
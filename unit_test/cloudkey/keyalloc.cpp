@@ -0,0 +1,88 @@
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+// Free pages of the hugetlb pool of pagekb KB pages, 0 if there is none.
+uint64_t freehugepages(const int pagekb)
+{
+    std::ifstream file("/sys/kernel/mm/hugepages/hugepages-" +
+                       std::to_string(pagekb) + "kB/free_hugepages");
+    uint64_t pages = 0;
+    file >> pages;
+    return file ? pages : 0;
+}
+
+// The memory is zeroed, 64-byte aligned and writable, and the pages granted
+// are the ones requested or a smaller kind.
+KeyPages allocate(const uint64_t bytes, const KeyAllocPolicy &policy)
+{
+    KeyAllocation allocation;
+    allocation.name = "test";
+    const std::shared_ptr<void> memory =
+        allocatekeymemory(bytes, policy, allocation);
+    c_assert(memory != nullptr);
+    c_assert(reinterpret_cast<uintptr_t>(memory.get()) % 64 == 0);
+    unsigned char *bytep = static_cast<unsigned char *>(memory.get());
+    for (uint64_t i = 0; i < bytes; i++) c_assert(bytep[i] == 0);
+    bytep[0] = bytep[bytes - 1] = 1;
+    c_assert(allocation.bytes == bytes);
+    c_assert(allocation.requested == policy.pages);
+    c_assert(allocation.granted <= allocation.requested);
+    c_assert(allocation.numanode == policy.numanode);
+    if (allocation.granted == KeyPages::transparent ||
+        allocation.granted == KeyPages::hugetlb2m)
+        c_assert(reinterpret_cast<uintptr_t>(memory.get()) % (1 << 21) == 0);
+    std::cout << allocation << std::endl;
+    return allocation.granted;
+}
+
+int main()
+{
+    // Not a multiple of any page size.
+    constexpr uint64_t bytes = (3 << 20) + 100;
+
+    c_assert(allocate(bytes, {KeyPages::normal, -1}) == KeyPages::normal);
+    const KeyPages thp = allocate(bytes, {KeyPages::transparent, -1});
+    c_assert(thp == KeyPages::transparent || thp == KeyPages::normal);
+
+    // hugetlb2m falls back to transparent huge pages when the pool is short.
+    const KeyPages hugetlb2m = allocate(bytes, {KeyPages::hugetlb2m, -1});
+    if (freehugepages(2048) >= 2)
+        c_assert(hugetlb2m == KeyPages::hugetlb2m);
+    else
+        c_assert(hugetlb2m == thp);
+    const uint64_t over2m = (freehugepages(2048) + 1) << 21;
+    c_assert(allocate(over2m, {KeyPages::hugetlb2m, -1}) == thp);
+
+    // hugetlb1g falls back to hugetlb2m, then to transparent huge pages.
+    const KeyPages hugetlb1g = allocate(bytes, {KeyPages::hugetlb1g, -1});
+    if (freehugepages(1048576) >= 1)
+        c_assert(hugetlb1g == KeyPages::hugetlb1g);
+    else
+        c_assert(hugetlb1g == hugetlb2m);
+
+    // A NUMA node takes pages of our own even for normal pages, whether or not
+    // mbind is allowed here.
+    c_assert(allocate(bytes, {KeyPages::normal, 0}) == KeyPages::normal);
+
+    const char *argv[] = {"keyalloc", "hugetlb2m", "1", "huge"};
+    const KeyAllocPolicy policy = keyallocpolicy(3, argv, 1);
+    c_assert(policy.pages == KeyPages::hugetlb2m && policy.numanode == 1);
+    c_assert(keyallocpolicy(1, argv, 1).pages == KeyPages::normal);
+    c_assert(keyallocpolicy(1, argv, 1).numanode == -1);
+    bool thrown = false;
+    try {
+        keyallocpolicy(4, argv, 3);
+    }
+    catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    c_assert(thrown);
+
+    std::cout << "Passed" << std::endl;
+}
@@ -0,0 +1,147 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+struct Interrupted {};
+
+bool exists(const std::string &path) { return std::ifstream(path).good(); }
+
+int main()
+{
+    const std::string path = "keygenjob_test.tfheppek";
+    const std::string progresspath = path + ".progress";
+    SecretKey sk;
+
+    // Under the same randomness a job writes the keys of the in-memory
+    // generators.
+    const Seed seed = seedgen();
+    {
+        GeneratorSeed jobseed(seed, 0);
+        KeyGenJob job(path, sk);
+        job.addiksk<lvl10param>();
+        job.addbkfft<lvl01param>();
+        job.run({}, 100);
+    }
+    c_assert(!exists(progresspath));
+    {
+        std::unique_ptr<KeySwitchingKey<lvl10param>> iksk(
+            new KeySwitchingKey<lvl10param>());
+        std::unique_ptr<BootstrappingKeyFFT<lvl01param>> bkfft(
+            new (std::align_val_t(64)) BootstrappingKeyFFT<lvl01param>());
+        {
+            GeneratorSeed keyseed(seed, 0);
+            ikskgen<lvl10param>(*iksk, sk);
+            bkfftgen<lvl01param>(*bkfft, sk);
+        }
+        EvalKey ek = mapevalkeyfile(path);
+        c_assert(std::memcmp(iksk.get(), &ek.getiksk<lvl10param>(),
+                             sizeof(*iksk)) == 0);
+        c_assert(std::memcmp(bkfft.get(), &ek.getbkfft<lvl01param>(),
+                             sizeof(*bkfft)) == 0);
+    }
+
+    // A job stopped after three blocks resumes from the fourth and gives a
+    // working key.
+    constexpr uint64_t blockrows = 64;
+    uint64_t blocks = 0;
+    const auto addkeys = [](KeyGenJob &job) {
+        job.addbkfft<lvl01param>();
+        job.addiksk<lvl10param>();
+    };
+    {
+        KeyGenJob job(path, sk);
+        addkeys(job);
+        bool stopped = false;
+        try {
+            job.run(
+                [&](const KeyGenJob::Progress &) {
+                    if (++blocks == 3) throw Interrupted();
+                },
+                blockrows);
+        }
+        catch (const Interrupted &) {
+            stopped = true;
+        }
+        c_assert(stopped && exists(progresspath));
+    }
+    bool thrown = false;
+    try {
+        mapevalkeyfile(path);
+    }
+    catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    c_assert(thrown);
+
+    // The progress file is only taken up by the same job.
+    thrown = false;
+    try {
+        KeyGenJob job(path, sk);
+        job.addiksk<lvl10param>();
+        job.run();
+    }
+    catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    c_assert(thrown && exists(progresspath));
+
+    // Nor is a key file whose section table differs from the job's, even at
+    // the same size.
+    const auto flipname = [&] {
+        std::fstream file(path, std::ios::in | std::ios::out |
+                                    std::ios::binary);
+        file.seekg(sizeof(EvalKeyFileHeader));
+        const char first = file.get();
+        file.seekp(sizeof(EvalKeyFileHeader));
+        file.put(first ^ 1);
+    };
+    flipname();
+    thrown = false;
+    try {
+        KeyGenJob job(path, sk);
+        addkeys(job);
+        job.run();
+    }
+    catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    c_assert(thrown && exists(progresspath));
+    flipname();
+
+    {
+        KeyGenJob job(path, sk);
+        addkeys(job);
+        uint64_t first = 0, last = 0;
+        job.run(
+            [&](const KeyGenJob::Progress &progress) {
+                if (first == 0) first = progress.rowsdone;
+                last = progress.rowsdone;
+                c_assert(progress.componentrowsdone <= progress.componentrows);
+                if (progress.rowsdone == progress.rows)
+                    std::cout << progress.rows << " rows, "
+                              << progress.rowspersec << " rows/s" << std::endl;
+            },
+            blockrows);
+        c_assert(first == 4 * blockrows);
+        c_assert(last == lvl01param::domainP::n + lvl10param::domainP::n);
+    }
+    c_assert(!exists(progresspath));
+
+    EvalKey ek = mapevalkeyfile(path);
+    for (int i = 0; i < 4; i++) {
+        const bool a = i & 1, b = (i >> 1) & 1;
+        TLWE<lvl1param> res;
+        HomNAND(res, bootsSymEncrypt<lvl1param>({a}, sk)[0],
+                bootsSymEncrypt<lvl1param>({b}, sk)[0], ek);
+        c_assert(bootsSymDecrypt<lvl1param>({res}, sk)[0] == !(a & b));
+    }
+    std::remove(path.c_str());
+    std::cout << "Passed" << std::endl;
+}
@@ -0,0 +1,115 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace TFHEpp;
+
+template <class Key>
+bool equal(const Key &a, const Key &b)
+{
+    return std::memcmp(&a, &b, sizeof(Key)) == 0;
+}
+
+// Generates the key with threads threads, seeding generator with seed, and
+// prints how long it took.
+template <class Key, class Gen>
+std::unique_ptr<Key> keygen(const char *name, const Seed &seed,
+                            const int threads, Gen gen)
+{
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#endif
+    std::unique_ptr<Key> key(new (std::align_val_t(64)) Key());
+    std::chrono::system_clock::time_point start, end;
+    start = std::chrono::system_clock::now();
+    {
+        GeneratorSeed keyseed(seed, 0);
+        gen(*key);
+    }
+    end = std::chrono::system_clock::now();
+    std::cout << name << " with " << threads << " threads: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end -
+                                                                       start)
+                     .count()
+              << "ms" << std::endl;
+    return key;
+}
+
+// Every key generation has to give the same key for the same seed, whatever
+// the number of threads.
+template <class Key, class Gen>
+void test(const char *name, Gen gen)
+{
+#ifdef _OPENMP
+    const int maxthreads = std::max(omp_get_max_threads(), 2);
+#else
+    const int maxthreads = 1;
+#endif
+    const Seed seed = seedgen();
+    const std::unique_ptr<Key> serial = keygen<Key>(name, seed, 1, gen);
+    const std::unique_ptr<Key> parallel =
+        keygen<Key>(name, seed, maxthreads, gen);
+    c_assert(equal(*serial, *parallel));
+    const std::unique_ptr<Key> other = keygen<Key>(name, seedgen(), 1, gen);
+    c_assert(!equal(*serial, *other));
+#ifdef _OPENMP
+    omp_set_num_threads(maxthreads);
+#endif
+}
+
+int main()
+{
+#ifndef _OPENMP
+    // The thread counts below then compare a serial run with a serial run.
+    std::cout << "Built without OpenMP: configure with -DUSE_OPENMP=ON to "
+                 "generate keys in parallel"
+              << std::endl;
+#endif
+    // Inside a GeneratorSeed the masks and the noise come from two streams of
+    // the seed, so the published masks say nothing about the noise.
+    {
+        const Seed seed = seedgen();
+        SeedExpander mask = seedexpander(seed, 1, SeedStream::mask);
+        SeedExpander noise = seedexpander(seed, 1, SeedStream::noise);
+        GeneratorSeed rowseed(seed, 1);
+        const uint64_t maskword = mask(), noiseword = noise();
+        c_assert(maskword != noiseword);
+        c_assert(generator() == maskword && noisegenerator() == noiseword);
+    }
+
+    SecretKey sk;
+    test<KeySwitchingKey<lvl10param>>(
+        "ikskgen<lvl10param>",
+        [&](KeySwitchingKey<lvl10param> &k) { ikskgen<lvl10param>(k, sk); });
+    test<SeededKeySwitchingKey<lvl10param>>(
+        "seededikskgen<lvl10param>", [&](SeededKeySwitchingKey<lvl10param> &k) {
+            seededikskgen<lvl10param>(k, sk);
+        });
+    test<BootstrappingKeyFFT<lvl01param>>(
+        "bkfftgen<lvl01param>", [&](BootstrappingKeyFFT<lvl01param> &k) {
+            bkfftgen<lvl01param>(k, sk);
+        });
+    test<AnnihilateKey<lvl1param>>(
+        "annihilatekeygen<lvl1param>", [&](AnnihilateKey<lvl1param> &k) {
+            annihilatekeygen<lvl1param>(k, sk);
+        });
+
+    // The keys still work.
+    EvalKey ek;
+    ek.emplacebkfft<lvl01param>(sk);
+    ek.emplaceiksk<lvl10param>(sk);
+    for (int i = 0; i < 10; i++) {
+        const bool a = i & 1, b = (i >> 1) & 1;
+        TLWE<lvl1param> res;
+        HomNAND(res, bootsSymEncrypt<lvl1param>({a}, sk)[0],
+                bootsSymEncrypt<lvl1param>({b}, sk)[0], ek);
+        c_assert(bootsSymDecrypt<lvl1param>({res}, sk)[0] == !(a & b));
+    }
+    std::cout << "Passed" << std::endl;
+}
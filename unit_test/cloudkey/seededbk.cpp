@@ -0,0 +1,97 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+// A seeded TRGSW expands to a TRGSW which decrypts like one from
+// trgswSymEncrypt: the external product with it multiplies by p.
+template <class P>
+void test(const SecretKey &sk)
+{
+    Polynomial<P> p = {};
+    p[0] = 1;
+    const Seed seed = seedgen();
+    SeededTRGSW<P> seeded;
+    trgswSymEncryptSeeded<P>(seeded, p, sk.key.get<P>(), seed, 0);
+    alignas(64) TRGSW<P> trgsw;
+    trgswSeededExpand<P>(trgsw, seeded, seed, 0);
+    alignas(64) TRGSWFFT<P> trgswfft, expanded;
+    ApplyFFT2trgsw<P>(trgswfft, trgsw);
+    trgswfftSeededExpand<P>(expanded, seeded, seed, 0);
+    c_assert(std::memcmp(&trgswfft, &expanded, sizeof(TRGSWFFT<P>)) == 0);
+
+    std::array<bool, P::n> m;
+    for (int i = 0; i < P::n; i++) m[i] = i % 3 == 0;
+    Polynomial<P> pm;
+    for (int i = 0; i < P::n; i++) pm[i] = m[i] ? P::mu : -P::mu;
+    const TRLWE<P> c = trlweSymEncrypt<P>(pm, sk.key.get<P>());
+    TRLWE<P> res;
+    trgswfftExternalProduct<P>(res, c, expanded);
+    c_assert(trlweSymDecrypt<P>(res, sk.key.get<P>()) == m);
+}
+
+int main()
+{
+    SecretKey sk;
+    test<lvl1param>(sk);
+    test<lvl2param>(sk);
+
+    // The client generates and uploads only the seeded key; the server
+    // expands it into the key used by the gates.
+    using brP = lvl01param;
+    const std::string path = "seededbk.tfheppek";
+    std::chrono::system_clock::time_point start, end;
+    {
+        EvalKey ek(sk);
+        start = std::chrono::system_clock::now();
+        ek.emplaceseedbk<brP>(sk);
+        end = std::chrono::system_clock::now();
+        std::cout << "seededbkgen: "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(
+                         end - start)
+                         .count()
+                  << "ms" << std::endl;
+        ek.emplaceiksk<lvl10param>(sk);
+        writeevalkeyfile(path, ek);
+    }
+
+    EvalKey ek = mapevalkeyfile(path);
+    start = std::chrono::system_clock::now();
+    ek.emplaceseedbk2bkfft<brP>();
+    end = std::chrono::system_clock::now();
+    std::cout << "bkfftexpand: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end -
+                                                                       start)
+                     .count()
+              << "ms" << std::endl;
+    std::cout << "key size: seeded "
+              << (sizeof(SeededBootstrappingKey<brP>) >> 20) << "MiB, torus "
+              << (sizeof(BootstrappingKey<brP>) >> 20)
+              << "MiB, FFT " << (sizeof(BootstrappingKeyFFT<brP>) >> 20)
+              << "MiB" << std::endl;
+
+    // bkexpand gives the TRGSWs bkfftexpand transformed.
+    std::unique_ptr<BootstrappingKey<brP>> bk(
+        new (std::align_val_t(64)) BootstrappingKey<brP>());
+    bkexpand<brP>(*bk, ek.getseedbk<brP>());
+    alignas(64) TRGSWFFT<lvl1param> trgswfft;
+    ApplyFFT2trgsw<lvl1param>(trgswfft, (*bk)[brP::domainP::n - 1][0]);
+    c_assert(std::memcmp(&trgswfft,
+                         &ek.getbkfft<brP>()[brP::domainP::n - 1][0],
+                         sizeof(trgswfft)) == 0);
+
+    for (int i = 0; i < 4; i++) {
+        const bool a = i & 1, b = (i >> 1) & 1;
+        TLWE<lvl1param> res;
+        HomNAND(res, bootsSymEncrypt<lvl1param>({a}, sk)[0],
+                bootsSymEncrypt<lvl1param>({b}, sk)[0], ek);
+        c_assert(bootsSymDecrypt<lvl1param>({res}, sk)[0] == !(a & b));
+    }
+    std::remove(path.c_str());
+    std::cout << "Passed" << std::endl;
+}
@@ -0,0 +1,111 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+// Encryption and decryption under a packed key against the full key: the same
+// randomness gives the same ciphertext, phases agree, and packing round-trips.
+template <class P>
+void test(const SecretKey &sk, const uint32_t num_test)
+{
+    std::random_device seed_gen;
+    std::default_random_engine engine(seed_gen());
+    std::uniform_int_distribution<typename P::T> torus(
+        0, std::numeric_limits<typename P::T>::max());
+    std::uniform_int_distribution<uint32_t> binary(0, 1);
+
+    const Key<P> key = sk.key.get<P>();
+    const PackedKey<P> packed = packkey<P>(key);
+    Key<P> unpacked;
+    unpackkey<P>(unpacked, packed);
+    c_assert(unpacked == key);
+
+    std::vector<TLWE<P>> c(num_test);
+    for (TLWE<P> &ci : c)
+        for (typename P::T &a : ci) a = torus(engine);
+    std::vector<typename P::T> expectedphase(num_test), phase(num_test);
+    std::chrono::system_clock::time_point start, end;
+    start = std::chrono::system_clock::now();
+    for (int i = 0; i < num_test; i++)
+        expectedphase[i] = tlweSymPhase<P>(c[i], key);
+    end = std::chrono::system_clock::now();
+    const double keyphasetime =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count();
+    start = std::chrono::system_clock::now();
+    for (int i = 0; i < num_test; i++)
+        phase[i] = tlweSymPhase<P>(c[i], packed);
+    end = std::chrono::system_clock::now();
+    const double packedphasetime =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count();
+    c_assert(phase == expectedphase);
+
+    const Seed seed = seedgen();
+    std::vector<uint8_t> p(num_test);
+    for (uint8_t &pi : p) pi = binary(engine);
+    std::vector<TLWE<P>> expected(num_test), res(num_test);
+    start = std::chrono::system_clock::now();
+    {
+        GeneratorSeed encseed(seed, 0);
+        for (int i = 0; i < num_test; i++)
+            expected[i] = tlweSymEncrypt<P>(encryptBit<P>(p[i]), key);
+    }
+    end = std::chrono::system_clock::now();
+    const double keytime =
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+            .count();
+    start = std::chrono::system_clock::now();
+    {
+        GeneratorSeed encseed(seed, 0);
+        for (int i = 0; i < num_test; i++)
+            res[i] = tlweSymEncrypt<P>(encryptBit<P>(p[i]), packed);
+    }
+    end = std::chrono::system_clock::now();
+    const double packedtime =
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+            .count();
+    c_assert(res == expected);
+    c_assert(bootsSymDecrypt<P>(res, packed) == p);
+
+    std::cout << "n = " << P::k * P::n << ": key " << sizeof(Key<P>)
+              << "B, packed " << sizeof(PackedKey<P>) << "B; phase "
+              << keyphasetime / num_test << "ns, packed "
+              << packedphasetime / num_test << "ns; encrypt "
+              << keytime / num_test << "us, packed " << packedtime / num_test
+              << "us" << std::endl;
+}
+
+int main()
+{
+    constexpr uint32_t num_test = 1000;
+    SecretKey sk;
+    test<lvl0param>(sk, num_test);
+    test<lvlhalfparam>(sk, num_test);
+    test<lvl1param>(sk, num_test);
+    test<lvl2param>(sk, num_test);
+    test<lvl3param>(sk, num_test);
+
+    std::stringstream ss;
+    {
+        cereal::PortableBinaryOutputArchive ar(ss);
+        ar(sk);
+    }
+    std::cout << "SecretKey: " << ss.str().size() << "B serialized, "
+              << sizeof(lweKey) << "B in memory" << std::endl;
+    SecretKey loaded;
+    {
+        cereal::PortableBinaryInputArchive ar(ss);
+        ar(loaded);
+    }
+    c_assert(loaded.key.lvl0 == sk.key.lvl0 &&
+             loaded.key.lvlhalf == sk.key.lvlhalf &&
+             loaded.key.lvl1 == sk.key.lvl1 && loaded.key.lvl2 == sk.key.lvl2 &&
+             loaded.key.lvl3 == sk.key.lvl3 && loaded.params == sk.params);
+
+    std::cout << "Passed" << std::endl;
+}
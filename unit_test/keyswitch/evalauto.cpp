@@ -0,0 +1,117 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+// EvalAuto as it was before the tables: the automorphism is applied to the
+// whole TRLWE and goes through the full external product.
+template <class P>
+void reference(TRLWE<P> &res, const TRLWE<P> &trlwe, const int d,
+               const TRGSWFFT<P> &autokey)
+{
+    Polynomial<P> polyb;
+    Automorphism<P>(polyb, trlwe[1], d);
+    res = {};
+    Automorphism<P>(res[1], trlwe[0], d);
+    trgswfftExternalProduct<P>(res, res, autokey);
+    for (int i = 0; i < P::n; i++) {
+        res[0][i] = -res[0][i];
+        res[1][i] = polyb[i] - res[1][i];
+    }
+}
+
+template <class P>
+void test(const SecretKey &sk, const AnnihilateKey<P> &ahk)
+{
+    constexpr int num = 4;
+    std::random_device seed_gen;
+    std::default_random_engine engine(seed_gen());
+    std::uniform_int_distribution<uint32_t> binary(0, 1);
+    std::uniform_int_distribution<int> digit(-32, 32);
+    std::uniform_int_distribution<typename P::T> torus(
+        0, std::numeric_limits<typename P::T>::max());
+
+    // The automorphism tables agree with Automorphism, also in the Fourier
+    // domain.
+    for (int d = 1; d < 2 * P::n; d += 2 * 37 + 2) {
+        Polynomial<P> a, expected, res;
+        for (int i = 0; i < P::n; i++) a[i] = torus(engine);
+        Automorphism<P>(expected, a, d);
+        Automorphism<P>(res, a, automorphismtablegen<P>(d));
+        for (int i = 0; i < P::n; i++) c_assert(res[i] == expected[i]);
+
+        for (int i = 0; i < P::n; i++)
+            a[i] = static_cast<typename P::T>(digit(engine));
+        Automorphism<P>(expected, a, d);
+        PolynomialInFD<P> afft, autofft, expectedfft;
+        TwistIFFT<P>(afft, a);
+        TwistIFFT<P>(expectedfft, expected);
+        AutomorphismInFD<P>(autofft, afft, automorphisminfdtablegen<P>(d));
+        for (int i = 0; i < P::n; i++)
+            c_assert(std::abs(autofft[i] - expectedfft[i]) < 1e-6);
+    }
+
+    std::array<Polynomial<P>, num> p;
+    std::array<TRLWE<P>, num> c;
+    for (int j = 0; j < num; j++) {
+        for (int i = 0; i < P::n; i++)
+            p[j][i] = binary(engine) > 0 ? P::mu : -P::mu;
+        c[j] = trlweSymEncrypt<P>(p[j], sk.key.get<P>());
+    }
+
+    // ahk[i] is the key of τ_(2^(nbit-i)+1).
+    std::array<int, num> d;
+    std::array<const TRGSWFFT<P> *, num> keys;
+    for (int f = 0; f < num; f++) {
+        d[f] = (1 << (P::nbit - f)) + 1;
+        keys[f] = &ahk[f];
+    }
+    std::array<TRLWE<P>, num> hoisted;
+    EvalAutoHoisted<P, num>(hoisted, c[0], d, keys);
+    for (int f = 0; f < num; f++) {
+        TRLWE<P> res, expected;
+        reference<P>(expected, c[0], d[f], ahk[f]);
+        EvalAuto<P>(res, c[0], d[f], ahk[f]);
+        for (int k = 0; k <= P::k; k++)
+            for (int i = 0; i < P::n; i++)
+                c_assert(res[k][i] == expected[k][i]);
+
+        Polynomial<P> autop;
+        Automorphism<P>(autop, p[0], d[f]);
+        const std::array<bool, P::n> dec =
+            trlweSymDecrypt<P>(hoisted[f], sk.key.get<P>());
+        for (int i = 0; i < P::n; i++)
+            c_assert(dec[i] == (autop[i] == P::mu));
+    }
+
+    std::array<TRLWE<P>, num> batch;
+    AnnihilateKeySwitchingbatch<P>(batch.data(), c.data(), num, ahk);
+    std::chrono::system_clock::time_point start, end;
+    start = std::chrono::system_clock::now();
+    for (int j = 0; j < num; j++) {
+        TRLWE<P> res;
+        AnnihilateKeySwitching<P>(res, c[j], ahk);
+        for (int k = 0; k <= P::k; k++)
+            for (int i = 0; i < P::n; i++)
+                c_assert(res[k][i] == batch[j][k][i]);
+    }
+    end = std::chrono::system_clock::now();
+    const double elapsed =
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+            .count();
+    std::cout << "AnnihilateKeySwitching: " << elapsed / num / 1000 << "ms"
+              << std::endl;
+}
+
+int main()
+{
+    SecretKey sk;
+    std::unique_ptr<AnnihilateKey<lvl1param>> ahk =
+        std::make_unique<AnnihilateKey<lvl1param>>();
+    annihilatekeygen<lvl1param>(*ahk, sk);
+    test<lvl1param>(sk, *ahk);
+    std::cout << "Passed" << std::endl;
+}
@@ -0,0 +1,80 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+// Checks that IdentityKeySwitchbatch matches IdentityKeySwitch for block sizes
+// and thread counts that do not divide the number of ciphertexts, and compares
+// their speed.
+template <class P>
+void test(const SecretKey &sk, const int num_test)
+{
+    using domainP = typename P::domainP;
+    using targetP = typename P::targetP;
+    std::random_device seed_gen;
+    std::default_random_engine engine(seed_gen());
+    std::uniform_int_distribution<uint32_t> binary(0, 1);
+
+    std::unique_ptr<KeySwitchingKey<P>> ksk(new (std::align_val_t(64))
+                                                KeySwitchingKey<P>());
+    ikskgen<P>(*ksk, sk);
+
+    std::vector<bool> p(num_test);
+    std::vector<TLWE<domainP>> tlwe(num_test);
+    std::vector<TLWE<targetP>> res(num_test), resbatch(num_test);
+    for (int i = 0; i < num_test; i++) {
+        p[i] = binary(engine) > 0;
+        tlwe[i] = tlweSymEncrypt<domainP>(p[i] ? domainP::mu : -domainP::mu,
+                                          sk.key.get<domainP>());
+    }
+
+    std::chrono::system_clock::time_point start, end;
+    start = std::chrono::system_clock::now();
+    for (int i = 0; i < num_test; i++)
+        IdentityKeySwitch<P>(res[i], tlwe[i], *ksk);
+    end = std::chrono::system_clock::now();
+    std::cout << "single: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(end -
+                                                                       start)
+                         .count() /
+                     1000.0 / num_test
+              << "ms" << std::endl;
+
+    for (const int block : {1, 5, 8, 16})
+        for (const int threads : {1, 3}) {
+            keyswitchconfig.block = block;
+            keyswitchconfig.threads = threads;
+            resbatch = {};
+            start = std::chrono::system_clock::now();
+            IdentityKeySwitchbatch<P>(resbatch.data(), tlwe.data(), num_test,
+                                      *ksk);
+            end = std::chrono::system_clock::now();
+            for (int i = 0; i < num_test; i++) {
+                c_assert(res[i] == resbatch[i]);
+                c_assert(p[i] == tlweSymDecrypt<targetP>(
+                                     resbatch[i], sk.key.get<targetP>()));
+            }
+            std::cout << "block " << block << " threads " << threads << ": "
+                      << std::chrono::duration_cast<std::chrono::microseconds>(
+                             end - start)
+                                 .count() /
+                             1000.0 / num_test
+                      << "ms" << std::endl;
+        }
+    keyswitchconfig = {};
+}
+
+int main(int argc, char **argv)
+{
+    const int num_test = argc > 1 ? std::atoi(argv[1]) : 100;
+    SecretKey sk;
+    std::cout << "lvl10" << std::endl;
+    test<lvl10param>(sk, num_test);
+    std::cout << "lvl20" << std::endl;
+    test<lvl20param>(sk, num_test);
+    std::cout << "Passed" << std::endl;
+}
@@ -0,0 +1,69 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+// Checks IdentityKeySwitchModSwitch against IdentityKeySwitch followed by
+// RotationIndicesgen and bootstraps through the fused path.
+int main(int argc, char **argv)
+{
+    const int num_test = argc > 1 ? std::atoi(argv[1]) : 100;
+    using iksP = lvl10param;
+    using bkP = lvl01param;
+    constexpr int domain_n = bkP::domainP::k * bkP::domainP::n;
+    std::random_device seed_gen;
+    std::default_random_engine engine(seed_gen());
+    std::uniform_int_distribution<uint32_t> binary(0, 1);
+
+    SecretKey sk;
+    EvalKey ek;
+    ek.emplacebkfft<bkP>(sk);
+    ek.emplaceiksk<iksP>(sk);
+
+    std::chrono::system_clock::time_point start, end;
+    double elapsed = 0, elapsedfused = 0;
+    for (int test = 0; test < num_test; test++) {
+        const bool p = binary(engine) > 0;
+        const TLWE<iksP::domainP> tlwe = tlweSymEncrypt<iksP::domainP>(
+            p ? iksP::domainP::mu : -iksP::domainP::mu,
+            sk.key.get<iksP::domainP>());
+
+        RotationIndices<bkP> idx, idxfused;
+        start = std::chrono::system_clock::now();
+        TLWE<iksP::targetP> tlwelvl0;
+        IdentityKeySwitch<iksP>(tlwelvl0, tlwe, ek.getiksk<iksP>());
+        RotationIndicesgen<bkP>(idx, tlwelvl0);
+        end = std::chrono::system_clock::now();
+        elapsed +=
+            std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+                .count();
+        start = std::chrono::system_clock::now();
+        IdentityKeySwitchModSwitch<iksP, bkP>(idxfused, tlwe,
+                                              ek.getiksk<iksP>());
+        end = std::chrono::system_clock::now();
+        elapsedfused +=
+            std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+                .count();
+
+        for (int i = 0; i < domain_n; i++) c_assert(idx[i] == idxfused[i]);
+        // The body is rounded once instead of twice, so it may land on the
+        // neighbouring rotation.
+        const int diff = (static_cast<int>(idx[domain_n]) -
+                          static_cast<int>(idxfused[domain_n]) +
+                          2 * bkP::targetP::n) %
+                         (2 * bkP::targetP::n);
+        c_assert(diff <= 1 || diff == 2 * bkP::targetP::n - 1);
+
+        TLWE<iksP::domainP> res;
+        GateBootstrapping<iksP, bkP, bkP::targetP::mu>(res, tlwe, ek);
+        c_assert(p == tlweSymDecrypt<iksP::domainP>(
+                          res, sk.key.get<iksP::domainP>()));
+    }
+    std::cout << "Passed" << std::endl;
+    std::cout << "IKS + modulus switch: " << elapsed / num_test / 1000
+              << "ms fused: " << elapsedfused / num_test / 1000 << "ms"
+              << std::endl;
+}
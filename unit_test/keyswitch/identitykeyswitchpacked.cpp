@@ -0,0 +1,74 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+// Checks that IdentityKeySwitch on the packed key layout gives exactly the
+// same ciphertexts as on the plain layout and compares their speed.
+template <class P>
+void test(const SecretKey &sk, const uint32_t num_test)
+{
+    using domainP = typename P::domainP;
+    using targetP = typename P::targetP;
+    std::random_device seed_gen;
+    std::default_random_engine engine(seed_gen());
+    std::uniform_int_distribution<uint32_t> binary(0, 1);
+
+    std::unique_ptr<KeySwitchingKey<P>> ksk(new (std::align_val_t(64))
+                                                KeySwitchingKey<P>());
+    ikskgen<P>(*ksk, sk);
+    std::unique_ptr<PackedKeySwitchingKey<P>> packed(
+        new (std::align_val_t(64)) PackedKeySwitchingKey<P>());
+    ikskpack<P>(*packed, *ksk);
+
+    std::vector<bool> p(num_test);
+    std::vector<TLWE<domainP>> tlwe(num_test);
+    std::vector<TLWE<targetP>> res(num_test), respacked(num_test);
+    for (int i = 0; i < num_test; i++) {
+        p[i] = binary(engine) > 0;
+        tlwe[i] = tlweSymEncrypt<domainP>(p[i] ? domainP::mu : -domainP::mu,
+                                          sk.key.get<domainP>());
+    }
+
+    std::chrono::system_clock::time_point start, end;
+    start = std::chrono::system_clock::now();
+    for (int i = 0; i < num_test; i++)
+        IdentityKeySwitch<P>(res[i], tlwe[i], *ksk);
+    end = std::chrono::system_clock::now();
+    const double elapsed =
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+            .count();
+    start = std::chrono::system_clock::now();
+    for (int i = 0; i < num_test; i++)
+        IdentityKeySwitch<P>(respacked[i], tlwe[i], *packed);
+    end = std::chrono::system_clock::now();
+    const double elapsedpacked =
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+            .count();
+
+    for (int i = 0; i < num_test; i++) {
+        c_assert(res[i] == respacked[i]);
+        c_assert(p[i] == tlweSymDecrypt<targetP>(respacked[i],
+                                                 sk.key.get<targetP>()));
+    }
+    std::cout << "plain: " << elapsed / num_test / 1000
+              << "ms packed: " << elapsedpacked / num_test / 1000 << "ms"
+              << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t num_test = argc > 1 ? std::atoi(argv[1]) : 100;
+    SecretKey sk;
+    std::cout << "lvl10" << std::endl;
+    test<lvl10param>(sk, num_test);
+    std::cout << "lvl20" << std::endl;
+    test<lvl20param>(sk, num_test);
+    std::cout << "lvl21" << std::endl;
+    test<lvl21param>(sk, num_test);
+    std::cout << "Passed" << std::endl;
+}
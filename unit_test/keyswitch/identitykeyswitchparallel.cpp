@@ -0,0 +1,71 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+// Checks that splitting a single IdentityKeySwitch between threads gives the
+// same ciphertext as the serial one and reports the latency per thread count.
+template <class P>
+void test(const SecretKey &sk, const int num_test)
+{
+    using domainP = typename P::domainP;
+    using targetP = typename P::targetP;
+    std::random_device seed_gen;
+    std::default_random_engine engine(seed_gen());
+    std::uniform_int_distribution<uint32_t> binary(0, 1);
+
+    std::unique_ptr<KeySwitchingKey<P>> ksk(new (std::align_val_t(64))
+                                                KeySwitchingKey<P>());
+    ikskgen<P>(*ksk, sk);
+
+    std::vector<bool> p(num_test);
+    std::vector<TLWE<domainP>> tlwe(num_test);
+    std::vector<TLWE<targetP>> res(num_test), respar(num_test);
+    for (int i = 0; i < num_test; i++) {
+        p[i] = binary(engine) > 0;
+        tlwe[i] = tlweSymEncrypt<domainP>(p[i] ? domainP::mu : -domainP::mu,
+                                          sk.key.get<domainP>());
+    }
+
+    keyswitchconfig.latency_threads = 1;
+    for (int i = 0; i < num_test; i++)
+        IdentityKeySwitch<P>(res[i], tlwe[i], *ksk);
+
+    for (const int threads : {1, 2, 3, 4}) {
+        keyswitchconfig.latency_threads = threads;
+        std::chrono::system_clock::time_point start, end;
+        start = std::chrono::system_clock::now();
+        for (int i = 0; i < num_test; i++)
+            IdentityKeySwitch<P>(respar[i], tlwe[i], *ksk);
+        end = std::chrono::system_clock::now();
+        for (int i = 0; i < num_test; i++) {
+            c_assert(res[i] == respar[i]);
+            c_assert(p[i] == tlweSymDecrypt<targetP>(respar[i],
+                                                     sk.key.get<targetP>()));
+        }
+        std::cout << threads << " threads: "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(
+                         end - start)
+                             .count() /
+                         1000.0 / num_test
+                  << "ms" << std::endl;
+    }
+    keyswitchconfig = {};
+}
+
+int main(int argc, char **argv)
+{
+    const int num_test = argc > 1 ? std::atoi(argv[1]) : 100;
+    // A single key switch stays serial unless latency_threads is set.
+    c_assert(keyswitchlatencythreads(lvl2param::k * lvl2param::n) == 1);
+    SecretKey sk;
+    std::cout << "lvl10" << std::endl;
+    test<lvl10param>(sk, num_test);
+    std::cout << "lvl20" << std::endl;
+    test<lvl20param>(sk, num_test);
+    std::cout << "Passed" << std::endl;
+}
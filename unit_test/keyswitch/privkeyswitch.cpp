@@ -0,0 +1,97 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+// Straightforward digit by digit private key switch to compare against.
+template <class P, class InP, class PrivKey>
+void reference(TRLWE<typename P::targetP> &res, const TLWE<InP> &tlwe,
+               const PrivKey &privksk)
+{
+    constexpr uint32_t mask = (1 << P::basebit) - 1;
+    constexpr int digits = std::numeric_limits<typename InP::T>::digits;
+    res = {};
+    for (int i = 0; i <= InP::k * InP::n; i++) {
+        const typename InP::T aibar =
+            tlwe[i] + (1ULL << (digits - (1 + P::basebit * P::t)));
+        for (int j = 0; j < P::t; j++) {
+            const uint32_t aij =
+                (aibar >> (digits - (j + 1) * P::basebit)) & mask;
+            if (aij != 0)
+                for (int k = 0; k < P::targetP::k + 1; k++)
+                    for (int p = 0; p < P::targetP::n; p++)
+                        res[k][p] -= privksk[i][j][aij - 1][k][p];
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const int num_test = argc > 1 ? std::atoi(argv[1]) : 10;
+    std::random_device seed_gen;
+    std::default_random_engine engine(seed_gen());
+    std::uniform_int_distribution<uint32_t> binary(0, 1);
+    SecretKey sk;
+
+    Polynomial<lvl1param> func = {};
+    func[0] = 1;
+    {
+        using P = lvl11param;
+        std::unique_ptr<PrivateKeySwitchingKey<P>> privksk(
+            new (std::align_val_t(64)) PrivateKeySwitchingKey<P>());
+        privkskgen<P>(*privksk, func, sk);
+        double elapsed = 0;
+        for (int test = 0; test < num_test; test++) {
+            const bool p = binary(engine) > 0;
+            const TLWE<lvl1param> tlwe = tlweSymEncrypt<lvl1param>(
+                p ? lvl1param::mu : -lvl1param::mu, sk.key.get<lvl1param>());
+            TRLWE<lvl1param> res, ref;
+            const auto start = std::chrono::system_clock::now();
+            PrivKeySwitch<P>(res, tlwe, *privksk);
+            const auto end = std::chrono::system_clock::now();
+            elapsed += std::chrono::duration_cast<std::chrono::microseconds>(
+                           end - start)
+                           .count();
+            reference<P, lvl1param>(ref, tlwe, *privksk);
+            c_assert(res == ref);
+            c_assert(p == trlweSymDecrypt<lvl1param>(
+                              res, sk.key.get<lvl1param>())[0]);
+        }
+        std::cout << "PrivKeySwitch lvl11: " << elapsed / num_test / 1000
+                  << "ms" << std::endl;
+    }
+    {
+        using P = lvl21param;
+        std::unique_ptr<SubsetPrivateKeySwitchingKey<P>> privksk(
+            new (std::align_val_t(64)) SubsetPrivateKeySwitchingKey<P>());
+        subprivkskgen<P>(*privksk, func, sk);
+        // The input is under the first coefficients of the lvl2 key.
+        Key<lvl1param> subsetkey;
+        for (int i = 0; i < lvl1param::k * lvl1param::n; i++)
+            subsetkey[i] = sk.key.get<lvl2param>()[i];
+        double elapsed = 0;
+        for (int test = 0; test < num_test; test++) {
+            const bool p = binary(engine) > 0;
+            const TLWE<lvl1param> tlwe = tlweSymEncrypt<lvl1param>(
+                p ? lvl1param::mu : -lvl1param::mu, subsetkey);
+            TRLWE<lvl1param> res, ref;
+            const auto start = std::chrono::system_clock::now();
+            SubsetPrivKeySwitch<P>(res, tlwe, *privksk);
+            const auto end = std::chrono::system_clock::now();
+            elapsed += std::chrono::duration_cast<std::chrono::microseconds>(
+                           end - start)
+                           .count();
+            reference<P, lvl1param>(ref, tlwe, *privksk);
+            c_assert(res == ref);
+            c_assert(p == trlweSymDecrypt<lvl1param>(
+                              res, sk.key.get<lvl1param>())[0]);
+        }
+        std::cout << "SubsetPrivKeySwitch lvl21: "
+                  << elapsed / num_test / 1000 << "ms" << std::endl;
+    }
+    std::cout << "Passed" << std::endl;
+}
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+// Phase of c as a signed fraction of the torus.
+template <class P>
+double phase(const TLWE<P> &c, const Key<P> &key)
+{
+    typename P::T phase = c[P::k * P::n];
+    for (int i = 0; i < P::k * P::n; i++) phase -= c[i] * key[i];
+    return static_cast<std::make_signed_t<typename P::T>>(phase) /
+           std::ldexp(1.0, std::numeric_limits<typename P::T>::digits);
+}
+
+// Prints the noise of IdentityKeySwitch by key precision. A precision is
+// marked safe when it at most doubles the variance of the full key.
+template <class P>
+void report(const char *name)
+{
+    constexpr uint32_t digits =
+        std::numeric_limits<typename P::targetP::T>::digits;
+    const KeySwitchNoise full = identitykeyswitchnoise<P>();
+    std::cout << name << ": key 2^" << std::log2(full.key) << " approx 2^"
+              << std::log2(full.approx) << " total 2^"
+              << std::log2(full.total()) << std::endl;
+    for (uint32_t bits = digits - 1; bits + 12 >= digits; bits--) {
+        const KeySwitchNoise noise = identitykeyswitchnoise<P>(bits);
+        std::cout << "  " << bits << " bits: quantization 2^"
+                  << std::log2(noise.quantization) << " total 2^"
+                  << std::log2(noise.total())
+                  << (noise.total() <= std::sqrt(2.0) * full.total()
+                          ? " safe"
+                          : " unsafe")
+                  << std::endl;
+    }
+}
+
+// Compares IdentityKeySwitch on the quantized key with the full key. Their
+// difference is the noise added by the quantization alone, and its standard
+// deviation has to match the estimate.
+template <class P, uint32_t bits>
+void test(const SecretKey &sk, const KeySwitchingKey<P> &ksk,
+          const uint32_t num_test)
+{
+    using domainP = typename P::domainP;
+    using targetP = typename P::targetP;
+    std::random_device seed_gen;
+    std::default_random_engine engine(seed_gen());
+    std::uniform_int_distribution<uint32_t> binary(0, 1);
+
+    std::unique_ptr<QuantizedKeySwitchingKey<P, bits>> quantized(
+        new (std::align_val_t(64)) QuantizedKeySwitchingKey<P, bits>());
+    ikskquantize<P, bits>(*quantized, ksk);
+
+    std::vector<bool> p(num_test);
+    std::vector<TLWE<domainP>> tlwe(num_test);
+    std::vector<TLWE<targetP>> res(num_test), resquantized(num_test);
+    for (int i = 0; i < num_test; i++) {
+        p[i] = binary(engine) > 0;
+        tlwe[i] = tlweSymEncrypt<domainP>(p[i] ? domainP::mu : -domainP::mu,
+                                          sk.key.get<domainP>());
+    }
+
+    std::chrono::system_clock::time_point start, end;
+    start = std::chrono::system_clock::now();
+    for (int i = 0; i < num_test; i++)
+        IdentityKeySwitch<P>(res[i], tlwe[i], ksk);
+    end = std::chrono::system_clock::now();
+    const double elapsed =
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+            .count();
+    start = std::chrono::system_clock::now();
+    for (int i = 0; i < num_test; i++)
+        IdentityKeySwitch<P, bits>(resquantized[i], tlwe[i], *quantized);
+    end = std::chrono::system_clock::now();
+    const double elapsedquantized =
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+            .count();
+
+    double variance = 0;
+    for (int i = 0; i < num_test; i++) {
+        TLWE<targetP> diff;
+        for (int j = 0; j <= targetP::k * targetP::n; j++)
+            diff[j] = resquantized[i][j] - res[i][j];
+        const double e = phase<targetP>(diff, sk.key.get<targetP>());
+        variance += e * e;
+    }
+    const double measured = std::sqrt(variance / num_test);
+    const double estimated = identitykeyswitchnoise<P>(bits).quantization;
+    std::cout << bits << " bits: quantization noise 2^" << std::log2(measured)
+              << " (estimated 2^" << std::log2(estimated) << ")" << std::endl;
+    c_assert(measured < 2 * estimated && measured > estimated / 2);
+
+    // Unsafe precisions only check the noise estimate.
+    if (identitykeyswitchnoise<P>(bits).total() <
+        std::sqrt(2.0) * identitykeyswitchnoise<P>().total())
+        for (int i = 0; i < num_test; i++)
+            c_assert(p[i] == tlweSymDecrypt<targetP>(resquantized[i],
+                                                     sk.key.get<targetP>()));
+    else
+        std::cout << "unsafe, decryption not checked" << std::endl;
+    std::cout << "key: " << sizeof(KeySwitchingKey<P>) / 1000000 << "MB -> "
+              << sizeof(QuantizedKeySwitchingKey<P, bits>) / 1000000
+              << "MB, full: " << elapsed / num_test / 1000
+              << "ms quantized: " << elapsedquantized / num_test / 1000 << "ms"
+              << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    // The noise check estimates a standard deviation, which takes more than a
+    // handful of samples.
+    const uint32_t num_test =
+        std::max(argc > 1 ? std::atoi(argv[1]) : 100, 100);
+    report<lvl10param>("lvl10");
+    report<lvl20param>("lvl20");
+    report<lvl21param>("lvl21");
+    c_assert(identitykeyswitchnoise<lvl21param>(lvl21param::quantizedbits)
+                 .total() <=
+             std::sqrt(2.0) * identitykeyswitchnoise<lvl21param>().total());
+
+    SecretKey sk;
+    std::unique_ptr<KeySwitchingKey<lvl21param>> ksk(
+        new (std::align_val_t(64)) KeySwitchingKey<lvl21param>());
+    ikskgen<lvl21param>(*ksk, sk);
+    test<lvl21param, lvl21param::quantizedbits>(sk, *ksk, num_test);
+    test<lvl21param, 24>(sk, *ksk, num_test);
+    test<lvl21param, 20>(sk, *ksk, num_test);
+    std::cout << "Passed" << std::endl;
+}
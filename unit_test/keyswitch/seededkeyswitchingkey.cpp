@@ -0,0 +1,72 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+// Checks that a SeededKeySwitchingKey expands deterministically, that the
+// expanded and the on-demand key switches agree and reports the compression.
+template <class P>
+void test(const SecretKey &sk, const int num_test)
+{
+    using domainP = typename P::domainP;
+    using targetP = typename P::targetP;
+    std::random_device seed_gen;
+    std::default_random_engine engine(seed_gen());
+    std::uniform_int_distribution<uint32_t> binary(0, 1);
+
+    EvalKey ek;
+    ek.emplaceseediksk<P>(sk);
+    ek.emplaceseediksk2iksk<P>();
+    const SeededKeySwitchingKey<P> &seeded = ek.getseediksk<P>();
+    const KeySwitchingKey<P> &ksk = ek.getiksk<P>();
+
+    std::unique_ptr<KeySwitchingKey<P>> again(new (std::align_val_t(64))
+                                                  KeySwitchingKey<P>());
+    ikskexpand<P>(*again, seeded);
+    c_assert(*again == ksk);
+
+    std::chrono::system_clock::time_point start, end;
+    double elapsed = 0, elapsedseeded = 0;
+    for (int i = 0; i < num_test; i++) {
+        const bool p = binary(engine) > 0;
+        const TLWE<domainP> tlwe = tlweSymEncrypt<domainP>(
+            p ? domainP::mu : -domainP::mu, sk.key.get<domainP>());
+        TLWE<targetP> res, resseeded;
+        start = std::chrono::system_clock::now();
+        IdentityKeySwitch<P>(res, tlwe, ksk);
+        end = std::chrono::system_clock::now();
+        elapsed +=
+            std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+                .count();
+        start = std::chrono::system_clock::now();
+        IdentityKeySwitch<P>(resseeded, tlwe, seeded);
+        end = std::chrono::system_clock::now();
+        elapsedseeded +=
+            std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+                .count();
+        c_assert(res == resseeded);
+        c_assert(p == tlweSymDecrypt<targetP>(res, sk.key.get<targetP>()));
+    }
+    std::cout << "size: " << sizeof(KeySwitchingKey<P>) << " -> "
+              << sizeof(SeededKeySwitchingKey<P>) << " bytes ("
+              << sizeof(KeySwitchingKey<P>) / sizeof(SeededKeySwitchingKey<P>)
+              << "x)" << std::endl;
+    std::cout << "expanded: " << elapsed / num_test / 1000
+              << "ms on demand: " << elapsedseeded / num_test / 1000 << "ms"
+              << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    const int num_test = argc > 1 ? std::atoi(argv[1]) : 10;
+    SecretKey sk;
+    std::cout << "lvl10" << std::endl;
+    test<lvl10param>(sk, num_test);
+    std::cout << "lvl20" << std::endl;
+    test<lvl20param>(sk, num_test);
+    std::cout << "Passed" << std::endl;
+}
@@ -0,0 +1,58 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <tfhe++.hpp>
+#include "c_assert.hpp"
+
+using namespace TFHEpp;
+
+// Packs num TLWEs into one TRLWE and checks every coefficient: the messages
+// sit at a stride of N / 2^ceil(log2(num)) and everything else decrypts to 0.
+template <uint num>
+void test(const SecretKey &sk, const EvalKey &ek)
+{
+    using P = lvl1param;
+    constexpr uint stride = P::n >> bits_needed<num - 1>();
+    std::random_device seed_gen;
+    std::default_random_engine engine(seed_gen());
+    std::uniform_int_distribution<uint32_t> binary(0, 1);
+
+    std::array<bool, num> p;
+    std::unique_ptr<std::array<TLWE<P>, num>> tlwe =
+        std::make_unique<std::array<TLWE<P>, num>>();
+    for (uint j = 0; j < num; j++) {
+        p[j] = binary(engine) > 0;
+        (*tlwe)[j] = tlweSymEncrypt<P>(p[j] ? P::mu : -P::mu, sk.key.get<P>());
+    }
+
+    TRLWE<P> packed;
+    const auto start = std::chrono::system_clock::now();
+    TLWE2TRLWEPacking<P, num>(packed, *tlwe, ek.getahk<P>());
+    const auto end = std::chrono::system_clock::now();
+
+    const Polynomial<P> phase = trlwePhase<P>(packed, sk.key.get<P>());
+    for (uint i = 0; i < P::n; i++) {
+        const int32_t coef = static_cast<int32_t>(phase[i]);
+        if (i % stride == 0 && i / stride < num)
+            c_assert((coef > 0) == p[i / stride]);
+        else
+            c_assert(std::abs(coef) < static_cast<int32_t>(P::mu / 2));
+    }
+    std::cout << num << " TLWEs: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end -
+                                                                       start)
+                     .count()
+              << "ms" << std::endl;
+}
+
+int main()
+{
+    SecretKey sk;
+    EvalKey ek;
+    ek.emplaceahk<lvl1param>(sk);
+    test<1>(sk, ek);
+    test<5>(sk, ek);
+    test<64>(sk, ek);
+    test<lvl1param::n>(sk, ek);
+    std::cout << "Passed" << std::endl;
+}
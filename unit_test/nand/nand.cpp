@@ -24,14 +24,20 @@ int main(int argc, char* argv[])
 
     cout << "num test: " << num_test << endl;
 
+    // Optional key page policy and NUMA node, e.g. "nand 100 hugetlb2m 0".
+    const KeyAllocPolicy policy = keyallocpolicy(argc, argv, 2);
+
     random_device seed_gen;
     default_random_engine engine(seed_gen());
     uniform_int_distribution<uint32_t> binary(0, 1);
 
     SecretKey* sk = new SecretKey();
     TFHEpp::EvalKey ek;
+    ek.allocpolicy = policy;
     ek.emplacebkfft<TFHEpp::lvl01param>(*sk);
     ek.emplaceiksk<TFHEpp::lvl10param>(*sk);
+    for (const KeyAllocation &allocation : ek.allocations)
+        cout << allocation << endl;
     vector<uint8_t> pa(num_test);
     vector<uint8_t> pb(num_test);
     vector<uint8_t> pres(num_test);
@@ -20,7 +20,7 @@ TLWEn<lvl1param, batch> cb;
 TLWEn<lvl1param, batch> cres;
 
 
-int main()
+int main(int argc, char* argv[])
 {
 
     cout << "batch: " << batch << endl;
@@ -31,6 +31,8 @@ int main()
 
     SecretKey* sk = new SecretKey();
     TFHEpp::EvalKey ek;
+    // Optional key page policy and NUMA node, e.g. "nand_batch transparent".
+    ek.allocpolicy = keyallocpolicy(argc, argv, 1);
     chrono::system_clock::time_point start, end;
     double elapsed;
 
@@ -50,6 +52,8 @@ int main()
 
     elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
     cout << elapsed / batch << "ms for emplaceiksk" << endl;
+    for (const KeyAllocation &allocation : ek.allocations)
+        cout << allocation << endl;
 
     for (j = 0; j < batch; j++) pa[j] = binary(engine) > 0;
     for (j = 0; j < batch; j++) pb[j] = binary(engine) > 0;
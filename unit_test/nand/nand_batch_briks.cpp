@@ -0,0 +1,63 @@
+#include "c_assert.hpp"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <tfhe++.hpp>
+
+using namespace std;
+using namespace TFHEpp;
+
+constexpr int batch = otherparam::batch;
+
+TLWEn<lvl0param, batch> ca;
+TLWEn<lvl0param, batch> cb;
+TLWEn<lvl0param, batch> cc;
+TLWEn<lvl0param, batch> cab;
+TLWEn<lvl0param, batch> cres;
+
+// Two chained layers of lvl0 -> lvl0 batch NAND gates:
+// res = NAND(NAND(a, b), c) without any lvl1 ciphertext in between.
+int main()
+{
+    cout << "batch: " << batch << endl;
+    random_device seed_gen;
+    default_random_engine engine(seed_gen());
+    uniform_int_distribution<uint32_t> binary(0, 1);
+
+    SecretKey *sk = new SecretKey();
+    EvalKey ek;
+    ek.emplacebkfft<lvl01param>(*sk);
+    ek.emplaceiksk<lvl10param>(*sk);
+
+    vector<uint8_t> pa(batch), pb(batch), pc(batch);
+    for (int j = 0; j < batch; j++) pa[j] = binary(engine) > 0;
+    for (int j = 0; j < batch; j++) pb[j] = binary(engine) > 0;
+    for (int j = 0; j < batch; j++) pc[j] = binary(engine) > 0;
+
+    vector<TLWE<lvl0param>> caa = bootsSymEncrypt<lvl0param>(pa, *sk);
+    vector<TLWE<lvl0param>> cbb = bootsSymEncrypt<lvl0param>(pb, *sk);
+    vector<TLWE<lvl0param>> ccc = bootsSymEncrypt<lvl0param>(pc, *sk);
+    for (int j = 0; j < batch; j++) {
+        ca[j] = caa[j];
+        cb[j] = cbb[j];
+        cc[j] = ccc[j];
+    }
+
+    chrono::system_clock::time_point start, end;
+    start = chrono::system_clock::now();
+    HomNANDbatch<lvl01param, lvl1param::mu, lvl10param, batch>(cab, ca, cb,
+                                                               ek);
+    HomNANDbatch<lvl01param, lvl1param::mu, lvl10param, batch>(cres, cab, cc,
+                                                               ek);
+    end = chrono::system_clock::now();
+
+    vector<TLWE<lvl0param>> ccres(cres.begin(), cres.end());
+    vector<uint8_t> pres = bootsSymDecrypt<lvl0param>(ccres, *sk);
+    for (int j = 0; j < batch; j++)
+        c_assert(pres[j] == !(!(pa[j] & pb[j]) && pc[j]));
+    cout << "Passed" << endl;
+
+    double elapsed =
+        chrono::duration_cast<chrono::milliseconds>(end - start).count();
+    cout << "single gate time: " << elapsed / (2 * batch) << "ms" << endl;
+}
@@ -0,0 +1,82 @@
+#include "c_assert.hpp"
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <tfhe++.hpp>
+
+using namespace std;
+using namespace TFHEpp;
+
+using brP = lvl01param;
+using iksP = lvl10param;
+constexpr lvl1param::T mu = lvl1param::mu;
+
+using Gate = function<void(TLWE<lvl0param> &, const TLWE<lvl0param> &,
+                           const TLWE<lvl0param> &, const EvalKey &)>;
+
+// Every lvl0 -> lvl0 gate against its truth table, then two chained layers
+// res = NAND(NAND(a, b), c) without any lvl1 ciphertext in between.
+int main(int argc, char *argv[])
+{
+    uint32_t num_test = 10;
+    if (argc > 1) {
+        std::stringstream str_stream(argv[1]);
+        str_stream >> num_test;
+    }
+    cout << "num test: " << num_test << endl;
+
+    random_device seed_gen;
+    default_random_engine engine(seed_gen());
+    uniform_int_distribution<uint32_t> binary(0, 1);
+
+    SecretKey *sk = new SecretKey();
+    EvalKey ek;
+    ek.emplacebkfft<brP>(*sk);
+    ek.emplaceiksk<iksP>(*sk);
+
+    vector<uint8_t> pa(num_test), pb(num_test), pc(num_test);
+    for (int i = 0; i < num_test; i++) pa[i] = binary(engine) > 0;
+    for (int i = 0; i < num_test; i++) pb[i] = binary(engine) > 0;
+    for (int i = 0; i < num_test; i++) pc[i] = binary(engine) > 0;
+    vector<TLWE<lvl0param>> ca = bootsSymEncrypt<lvl0param>(pa, *sk);
+    vector<TLWE<lvl0param>> cb = bootsSymEncrypt<lvl0param>(pb, *sk);
+    vector<TLWE<lvl0param>> cc = bootsSymEncrypt<lvl0param>(pc, *sk);
+    vector<TLWE<lvl0param>> cres(num_test), cab(num_test);
+
+    const vector<pair<Gate, function<bool(bool, bool)>>> gates = {
+        {HomNAND<brP, mu, iksP>, [](bool a, bool b) { return !(a & b); }},
+        {HomNOR<brP, mu, iksP>, [](bool a, bool b) { return !(a | b); }},
+        {HomXNOR<brP, mu, iksP>, [](bool a, bool b) { return a == b; }},
+        {HomAND<brP, mu, iksP>, [](bool a, bool b) { return a & b; }},
+        {HomOR<brP, mu, iksP>, [](bool a, bool b) { return a | b; }},
+        {HomXOR<brP, mu, iksP>, [](bool a, bool b) { return a != b; }},
+        {HomANDNY<brP, mu, iksP>, [](bool a, bool b) { return !a & b; }},
+        {HomANDYN<brP, mu, iksP>, [](bool a, bool b) { return a & !b; }},
+        {HomORNY<brP, mu, iksP>, [](bool a, bool b) { return !a | b; }},
+        {HomORYN<brP, mu, iksP>, [](bool a, bool b) { return a | !b; }}};
+    for (const auto &[gate, truth] : gates) {
+        for (int i = 0; i < num_test; i++) gate(cres[i], ca[i], cb[i], ek);
+        vector<uint8_t> pres = bootsSymDecrypt<lvl0param>(cres, *sk);
+        for (int i = 0; i < num_test; i++)
+            c_assert(pres[i] == truth(pa[i], pb[i]));
+    }
+
+    chrono::system_clock::time_point start, end;
+    start = chrono::system_clock::now();
+    for (int i = 0; i < num_test; i++) {
+        HomNAND<brP, mu, iksP>(cab[i], ca[i], cb[i], ek);
+        HomNAND<brP, mu, iksP>(cres[i], cab[i], cc[i], ek);
+    }
+    end = chrono::system_clock::now();
+
+    vector<uint8_t> pres = bootsSymDecrypt<lvl0param>(cres, *sk);
+    for (int i = 0; i < num_test; i++)
+        c_assert(pres[i] == !(!(pa[i] & pb[i]) && pc[i]));
+    cout << "Passed" << endl;
+    double elapsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+            .count();
+    cout << elapsed / (2 * num_test) << "ms per gate" << endl;
+}